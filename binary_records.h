@@ -0,0 +1,364 @@
+// binary_records.h
+#ifndef BINARY_RECORDS_H
+#define BINARY_RECORDS_H
+
+// Compact, versioned binary encoding for records (tasks, donors), for
+// snapshots, replication and passing records between processes.
+//
+// A buffer starts with the magic "DSAB", a major and a minor format version
+// byte and a record type byte. Then come frames, each a varint (size << 1 | kind) and `size`
+// bytes:
+//   kind 0: a record, its fields in the order the record type defines
+//   kind 1: a dictionary entry (the string itself), numbered from 1 in order
+// Field encodings:
+//   integers     LEB128 varint, signed ones zigzagged so small negatives stay short
+//   strings      varint length + bytes
+//   dict strings varint number of a dictionary entry (0 = ""); the writer
+//                emits the entry frame before the first record that uses it,
+//                so repeated values (developer, city, blood type) cost a byte
+//   dates        varint days since 1970-01-01 + 1 (0 = no date); anything
+//                that isn't a real YYYY-MM-DD date from 1970 on is stored
+//                as no date
+// A new minor version may only add fields at the end of a record (or new
+// record types); a reader accepts any minor version and skips fields it
+// doesn't know, because every record carries its own size. Any other change
+// bumps the major version, which older readers refuse.
+//
+// BinaryReader works on any byte range (a file mapped into memory, a network
+// buffer) without copying: strings come back as string_views into it, valid
+// while the buffer is. Malformed input never reads outside the range; the
+// cursor just reports it as not ok.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "containers.h"
+
+const uint8_t BINARY_RECORDS_MAJOR = 1;
+const uint8_t BINARY_RECORDS_MINOR = 0;
+
+// Days since 1970-01-01 for a YYYY-MM-DD date, plus one; 0 if it isn't one
+inline uint64_t packDate(std::string_view date) {
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') return 0;
+    for (int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (date[i] < '0' || date[i] > '9') return 0;
+    }
+    int y = (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0');
+    unsigned m = static_cast<unsigned>((date[5] - '0') * 10 + (date[6] - '0'));
+    unsigned d = static_cast<unsigned>((date[8] - '0') * 10 + (date[9] - '0'));
+    static const unsigned monthDays[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = y % 4 == 0 && (y % 100 != 0 || y % 400 == 0);
+    if (m < 1 || m > 12 || d < 1 || d > monthDays[m - 1] || (m == 2 && d == 29 && !leap)) return 0;
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long long days = static_cast<long long>(era) * 146097 + static_cast<long long>(doe) - 719468;
+    return days < 0 ? 0 : static_cast<uint64_t>(days) + 1;
+}
+
+// Inverse of packDate ("" for 0)
+inline std::string unpackDate(uint64_t packed) {
+    if (packed == 0) return "";
+    long long z = static_cast<long long>(packed - 1) + 719468;
+    long long era = z / 146097;
+    unsigned doe = static_cast<unsigned>(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long y = static_cast<long long>(yoe) + era * 400;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    y += m <= 2;
+    if (y > 9999) {
+        char out[48];
+        snprintf(out, sizeof(out), "%lld-%02u-%02u", y, m, d);
+        return out;
+    }
+    char out[10] = {static_cast<char>('0' + y / 1000), static_cast<char>('0' + y / 100 % 10),
+                    static_cast<char>('0' + y / 10 % 10), static_cast<char>('0' + y % 10), '-',
+                    static_cast<char>('0' + m / 10), static_cast<char>('0' + m % 10), '-',
+                    static_cast<char>('0' + d / 10), static_cast<char>('0' + d % 10)};
+    return std::string(out, 10);
+}
+
+class BinaryWriter {
+private:
+    // Fields are written straight into `out` after a one-byte slot for the
+    // record's size; a longer size or new dictionary entries shift the record
+    // up once it is complete
+    std::string out;
+    size_t used = 0;        // bytes of `out` in use
+    size_t recordStart = 0; // the current record's size slot
+    std::string entries;    // dictionary frames the current record introduces
+    FlatHashMap<std::string, uint64_t> dictionary;
+    uint64_t nextEntry = 1;
+    uint8_t type;
+
+    char* room(size_t n) {
+        if (used + n > out.size()) out.resize(std::max(out.size() * 2, used + n + 256));
+        return &out[used];
+    }
+
+    static size_t writeVarint(char* to, uint64_t v) {
+        size_t n = 0;
+        while (v >= 0x80) {
+            to[n++] = static_cast<char>(v | 0x80);
+            v >>= 7;
+        }
+        to[n++] = static_cast<char>(v);
+        return n;
+    }
+
+    void appendVarint(uint64_t v) {
+        used += writeVarint(room(10), v);
+    }
+
+    void start() {
+        memcpy(room(7), "DSAB", 4);
+        out[used + 4] = static_cast<char>(BINARY_RECORDS_MAJOR);
+        out[used + 5] = static_cast<char>(BINARY_RECORDS_MINOR);
+        out[used + 6] = static_cast<char>(type);
+        used += 7;
+        recordStart = used++;
+    }
+
+public:
+    explicit BinaryWriter(uint8_t recordType) : type(recordType) {
+        start();
+    }
+
+    // Allocates room for about `bytes` of records up front (growing the
+    // buffer while writing costs as much as the encoding itself)
+    void reserve(size_t bytes) {
+        if (bytes > out.size()) out.resize(bytes);
+    }
+
+    void putUint(uint64_t v) {
+        appendVarint(v);
+    }
+
+    void putInt(long long v) {
+        uint64_t u = static_cast<uint64_t>(v);
+        appendVarint((u << 1) ^ (v < 0 ? ~uint64_t(0) : 0));
+    }
+
+    void putString(std::string_view s) {
+        char* to = room(10 + s.size());
+        size_t n = writeVarint(to, s.size());
+        memcpy(to + n, s.data(), s.size());
+        used += n + s.size();
+    }
+
+    // For fields with few distinct values
+    void putDictString(const std::string& s) {
+        if (s.empty()) {
+            appendVarint(0);
+            return;
+        }
+        if (const uint64_t* known = dictionary.find(s)) {
+            appendVarint(*known);
+            return;
+        }
+        dictionary.insert(s, nextEntry);
+        char header[10];
+        entries.append(header, writeVarint(header, s.size() << 1 | 1));
+        entries += s;
+        appendVarint(nextEntry++);
+    }
+
+    void putDate(std::string_view date) {
+        appendVarint(packDate(date));
+    }
+
+    // Frames the fields put since the last call as one record
+    void endRecord() {
+        size_t size = used - recordStart - 1;
+        char header[10];
+        size_t headerSize = writeVarint(header, size << 1);
+        size_t shift = entries.size() + headerSize - 1;
+        if (shift > 0) {
+            room(shift);
+            memmove(&out[recordStart + 1 + shift], &out[recordStart + 1], size);
+            memcpy(&out[recordStart], entries.data(), entries.size());
+            entries.clear();
+            used += shift;
+        }
+        memcpy(&out[recordStart + shift + 1 - headerSize], header, headerSize);
+        recordStart = used++;
+    }
+
+    // The records so far, header included
+    std::string_view buffer() const {
+        return std::string_view(out.data(), recordStart);
+    }
+
+    // Hands the buffer over; the writer starts a new one with an empty dictionary
+    std::string take() {
+        out.resize(recordStart);
+        std::string done = std::move(out);
+        out.clear();
+        used = 0;
+        entries.clear();
+        dictionary.clear();
+        nextEntry = 1;
+        start();
+        return done;
+    }
+};
+
+// Reads one record's fields in order
+class RecordCursor {
+private:
+    const char* pos = nullptr;
+    const char* end = nullptr;
+    const std::vector<std::string_view>* dictionary = nullptr;
+    uint8_t type = 0;
+    bool good = true;
+
+    friend class BinaryReader;
+
+public:
+    // The buffer's record type, for codecs to check before decoding
+    uint8_t recordType() const {
+        return type;
+    }
+
+    uint64_t getUint() {
+        if (pos < end && static_cast<uint8_t>(*pos) < 0x80) return static_cast<uint8_t>(*pos++);
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= end) break;
+            uint8_t b = static_cast<uint8_t>(*pos++);
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        good = false;
+        pos = end;
+        return 0;
+    }
+
+    long long getInt() {
+        uint64_t u = getUint();
+        return static_cast<long long>((u >> 1) ^ (~(u & 1) + 1));
+    }
+
+    std::string_view getString() {
+        uint64_t n = getUint();
+        if (n > static_cast<uint64_t>(end - pos)) {
+            good = false;
+            pos = end;
+            return {};
+        }
+        std::string_view s(pos, static_cast<size_t>(n));
+        pos += n;
+        return s;
+    }
+
+    std::string_view getDictString() {
+        uint64_t n = getUint();
+        if (n == 0) return {};
+        if (n > dictionary->size()) {
+            good = false;
+            return {};
+        }
+        return (*dictionary)[n - 1];
+    }
+
+    // Days since 1970-01-01 + 1, 0 = no date (unpackDate() makes it a string)
+    uint64_t getDate() {
+        return getUint();
+    }
+
+    // False once a field ran past the record or was malformed
+    bool ok() const {
+        return good;
+    }
+};
+
+class BinaryReader {
+private:
+    const char* pos;
+    const char* end;
+    uint8_t type = 0;
+    uint8_t major = 0;
+    uint8_t minor = 0;
+    bool good = true;
+    std::vector<std::string_view> dictionary;
+
+    bool getFrameHeader(uint64_t& header) {
+        RecordCursor c;
+        c.pos = pos;
+        c.end = end;
+        header = c.getUint();
+        pos = c.pos;
+        return c.good;
+    }
+
+public:
+    // Refuses a buffer from another major version; any minor version reads
+    BinaryReader(const char* data, size_t size) : pos(data), end(data + size) {
+        if (size < 7 || memcmp(data, "DSAB", 4) != 0 || static_cast<uint8_t>(data[4]) != BINARY_RECORDS_MAJOR) {
+            good = false;
+            pos = end;
+            return;
+        }
+        major = static_cast<uint8_t>(data[4]);
+        minor = static_cast<uint8_t>(data[5]);
+        type = static_cast<uint8_t>(data[6]);
+        pos += 7;
+    }
+
+    explicit BinaryReader(std::string_view buffer) : BinaryReader(buffer.data(), buffer.size()) {}
+
+    // Moves to the next record; false at the end or on a malformed frame
+    bool next(RecordCursor& record) {
+        while (pos < end) {
+            uint64_t header;
+            if (!getFrameHeader(header) || (header >> 1) > static_cast<uint64_t>(end - pos)) {
+                good = false;
+                pos = end;
+                return false;
+            }
+            size_t size = static_cast<size_t>(header >> 1);
+            const char* frame = pos;
+            pos += size;
+            if (header & 1) {
+                dictionary.emplace_back(frame, size);
+                continue;
+            }
+            record.pos = frame;
+            record.end = frame + size;
+            record.dictionary = &dictionary;
+            record.type = type;
+            record.good = true;
+            return true;
+        }
+        return false;
+    }
+
+    // False if the header was wrong or a frame ran past the end
+    bool ok() const {
+        return good;
+    }
+
+    uint8_t recordType() const {
+        return type;
+    }
+
+    uint8_t majorVersion() const {
+        return major;
+    }
+
+    // May be newer than BINARY_RECORDS_MINOR; records then carry extra fields
+    uint8_t minorVersion() const {
+        return minor;
+    }
+};
+
+#endif
@@ -1,28 +1,47 @@
 #include <iostream>
+#include <iomanip>
 #include <limits> // For numeric_limits
 #include <cctype>
+#include <climits>
+#include <cmath>
 #include <ctime>
-#include <pqxx/pqxx> 
-#include <iostream>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include "bloodbank.h"
+#include "containers.h"
+#include "dashboard.h"
+#include "donor_attributes.h"
+#include "donor_search.h"
+#include "eligibility.h"
+#include "export.h"
+#include "health_store.h"
+#include "http_server.h"
+#include "inventory.h"
+#include "json.h"
+#include "loadgen.h"
+#include "location_index.h"
+#include "metrics.h"
+#include "mvcc.h"
+#include "notify.h"
+#include "session.h"
 using namespace std;
-struct Donor {
-    string firstName;
-    string lastName;
-    string gender;
-    string phone;
-    string username;
-    string password;
-    string bloodType;
-    string email;
-    string city;
-    string region;
-    string kebele;
-    string worda;
-    Donor* next;
-};
-
-
-Donor* donorHead = nullptr;
+mutex storeMutex; // guards the donor, appointment and health data below
+
+IntrusiveList<Donor> donors; // newest first
+FlatHashMap<string, Donor*> donorsByUsername; // username -> donor, for O(1) lookups
+vector<Donor*> donorsById;
+// Donors by id for lock-free listings. A donor is not changed once added,
+// so the published version is just the pointer.
+VersionStore<const Donor*> donorVersions;
+DonorSearchIndex donorSearch; // trigrams of names and locations, by donor id
+LocationIndex locations;       // region > city > worda > kebele, by blood type
+DonorAttributeIndex donorAttributes; // bitmaps per gender/blood type/region/city/month
 struct Appointment {
     string donorUsername;
     string date;  
@@ -31,7 +50,28 @@ struct Appointment {
     Appointment* next;
 };
 
-Appointment* appointmentHead = nullptr;
+IntrusiveList<Appointment> appointments; // in booking order
+
+// Logged-in state lives in a session instead of the menu loops, so every
+// authenticated operation is one token lookup.
+struct SessionState {
+    Donor* donor;     // nullptr for the supervisor
+    bool supervisor;
+};
+
+SessionManager<SessionState> sessions;
+string supervisorToken; // console supervisor session, kept across menu visits
+
+HealthStore healthStore; // medical history per donor id
+EligibilityTracker eligibility; // next day each donor may donate, per donor id
+Inventory inventory; // collected blood units, FEFO per blood type and component
+Dashboard dashboard; // supervisor overview, updated by every event below
+bool checkDashboard = false; // --check-dashboard: compare each read with a full recount
+
+map<int, vector<Appointment*>> appointmentsByDay; // time index: day -> appointments
+NotificationPipeline notifications;               // SMS/email to donors
+int remindersSentForDay = INT_MIN;                // last day reminders went out for
+size_t remindersSentCount = 0;                    // ...and how many of that day's appointments
 
 string getCurrentDate() {
     time_t now = time(0);
@@ -48,23 +88,92 @@ bool isDateValid(const string& inputDate) {
     return inputDate >= today;
 }
 
+// Converts a YYYY-MM-DD date to days since 1970-01-01
+int daysFromDate(const string& date) {
+    int y = stoi(date.substr(0, 4));
+    unsigned m = static_cast<unsigned>(stoi(date.substr(5, 2)));
+    unsigned d = static_cast<unsigned>(stoi(date.substr(8, 2)));
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+// Converts days since 1970-01-01 back to YYYY-MM-DD
+string dateFromDays(int days) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int y = static_cast<int>(yoe) + era * 400;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    y += m <= 2;
+
+    char dateStr[32];
+    snprintf(dateStr, sizeof(dateStr), "%04d-%02u-%02u", y, m, d);
+    return string(dateStr);
+}
+
 void addAppointment(const string& donorUsername, const string& date, const string& time, const string& message) {
+    TIME_OPERATION("bloodbank_add_appointment");
     Appointment* newApp = new Appointment;
     newApp->donorUsername = donorUsername;
     newApp->date = date;
     newApp->time = time;
     newApp->message = message;
-    newApp->next = nullptr;
+    appointments.pushBack(newApp);
+    appointmentsByDay[daysFromDate(date)].push_back(newApp);
+    dashboard.onAppointmentBooked(daysFromDate(date));
+}
 
-    if (appointmentHead == nullptr) {
-        appointmentHead = newApp;
-    } else {
-        Appointment* temp = appointmentHead;
-        while (temp->next != nullptr) {
-            temp = temp->next;
-        }
-        temp->next = newApp;
-    }
+
+// Stores a reading and updates the donor's eligibility from it
+void recordHealth(const Donor* donor, const HealthReading& reading) {
+    TIME_OPERATION("bloodbank_record_health");
+    healthStore.record(donor->id, reading);
+    int before = eligibility.nextEligibleDay(donor->id);
+    eligibility.onHealthEvent(donor->id, reading.day, reading.flags);
+    int after = eligibility.nextEligibleDay(donor->id);
+    if (after != before) dashboard.onEligibilityChanged(Inventory::typeIndex(donor->bloodType), before, after);
+}
+
+// Adds a donated unit to stock and returns its id
+int receiveUnit(const Donor* donor, int type, Component component, int day) {
+    dashboard.onUnitReceived(type, day + Inventory::shelfLife(component) - 1);
+    return inventory.receive(type, component, day, donor->id);
+}
+
+// Blood type a donated unit is stocked under: the donor's, or `given` when
+// the donor registered without an Rh sign (or without a type). -1 if neither
+// is a full type, or `given` contradicts what the donor registered.
+int unitBloodType(const Donor* donor, const string& given) {
+    int registered = Inventory::typeIndex(donor->bloodType);
+    if (given.empty()) return registered;
+    int type = Inventory::typeIndex(given);
+    if (type < 0) return -1;
+    if (registered >= 0) return type == registered ? type : -1;
+    string abo = given.substr(0, given.size() - 1);
+    return donor->bloodType.empty() || donor->bloodType == abo ? type : -1;
+}
+
+// Issues units for today, soonest expiry first
+vector<BloodUnit> issueUnits(int type, Component component, int count) {
+    vector<BloodUnit> units = inventory.issue(type, component, count, daysFromDate(getCurrentDate()));
+    dashboard.onUnitsIssued(units);
+    return units;
+}
+
+// Why a donor can't book on the given day, or "" if they can
+string eligibilityError(const Donor* donor, const string& date) {
+    if (eligibility.isEligibleOn(donor->id, daysFromDate(date))) return "";
+    int next = eligibility.nextEligibleDay(donor->id);
+    if (next == INT_MAX) return "You are permanently deferred from donating.";
+    return "You are not eligible to donate until " + dateFromDays(next) + ".";
 }
 
 
@@ -100,7 +209,7 @@ bool isValidPassword(const string& pass) {
 
 // Check blood type validity or empty
 bool isValidBloodType(const string& blood) {
-    const string validTypes[] = {"A", "A+", "A-", "B", "B+", "B-", "AB", "O", "O+", "O-"};
+    const string validTypes[] = {"A", "A+", "A-", "B", "B+", "B-", "AB", "AB+", "AB-", "O", "O+", "O-"};
     if (blood.empty()) return true;
     for (const auto& t : validTypes) {
         if (blood == t) return true;
@@ -116,17 +225,179 @@ bool isValidEmail(const string& email) {
     return (at_pos != string::npos && dot_pos != string::npos);
 }
 
+// Check date has the YYYY-MM-DD shape
+bool isValidDateFormat(const string& date) {
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') return false;
+    for (int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (!isdigit(date[i])) return false;
+    }
+    int month = stoi(date.substr(5, 2));
+    int day = stoi(date.substr(8, 2));
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+// Check time has the HH:MM (24-hour) shape
+bool isValidTimeFormat(const string& t) {
+    if (t.size() != 5 || t[2] != ':') return false;
+    if (!isdigit(t[0]) || !isdigit(t[1]) || !isdigit(t[3]) || !isdigit(t[4])) return false;
+    return stoi(t.substr(0, 2)) < 24 && stoi(t.substr(3, 2)) < 60;
+}
+
+// Returns the first validation error for a complete donor record, or "" if valid
+string validateDonor(const DonorInput& d) {
+    if (!isAlphaString(d.firstName)) return "Invalid first name. Use letters only.";
+    if (!isAlphaString(d.lastName)) return "Invalid last name. Use letters only.";
+    if (!isValidGender(d.gender)) return "Invalid gender. Enter 'male' or 'female'.";
+    if (!isValidPhone(d.phone)) return "Invalid phone number.";
+    if (d.username.empty()) return "Username cannot be empty.";
+    if (!isValidPassword(d.password)) return "Password too short.";
+    if (!isValidBloodType(d.bloodType)) return "Invalid blood type.";
+    if (!isValidEmail(d.email)) return "Invalid email format.";
+    if (!isAlphaString(d.city)) return "Invalid city. Use letters only.";
+    if (!isAlphaString(d.region)) return "Invalid region. Use letters only.";
+    if (!isAlphaString(d.kebele)) return "Invalid kebele. Use letters only.";
+    if (!isAlphaString(d.worda)) return "Invalid worda. Use letters only.";
+    return "";
+}
+
+Donor* findDonorByUsername(const string& username) {
+    TIME_OPERATION("bloodbank_find_donor");
+    Donor** found = donorsByUsername.find(username);
+    return found ? *found : nullptr;
+}
+
+// Returns the donor for a username/password pair, or nullptr
+Donor* authenticateDonor(const string& username, const string& password) {
+    TIME_OPERATION("bloodbank_login");
+    Donor* d = findDonorByUsername(username);
+    return (d != nullptr && d->password == password) ? d : nullptr;
+}
+
+bool isSupervisor(const string& username, const string& password) {
+    return username == "sup1" && password == "sup123456";
+}
+
+// Add new donor to front of list
+void addDonor(Donor* newDonor) {
+    TIME_OPERATION("bloodbank_add_donor");
+    if (newDonor->registeredOn.empty()) newDonor->registeredOn = getCurrentDate();
+    donors.pushFront(newDonor);
+    donorsByUsername[newDonor->username] = newDonor;
+    newDonor->id = static_cast<int>(donorsById.size());
+    donorsById.push_back(newDonor);
+    donorVersions.insert(newDonor);
+    donorSearch.add(newDonor->id, {newDonor->firstName, newDonor->lastName, newDonor->city,
+                                   newDonor->kebele, newDonor->worda});
+    locations.add(newDonor->id, Inventory::typeIndex(newDonor->bloodType), newDonor->region,
+                  newDonor->city, newDonor->worda, newDonor->kebele);
+    donorAttributes.add(newDonor->id, newDonor->gender, newDonor->bloodType, newDonor->region,
+                        newDonor->city, newDonor->registeredOn);
+    dashboard.onDonorRegistered(Inventory::typeIndex(newDonor->bloodType));
+}
+
+// ================= Core API (bloodbank.h) =================
+
+BankResult registerDonor(DonorInput&& input, const Donor** created) {
+    string error = validateDonor(input);
+    if (!error.empty()) return {BANK_INVALID_INPUT, error};
+
+    lock_guard<mutex> lock(storeMutex);
+    if (findDonorByUsername(input.username) != nullptr) return {BANK_USERNAME_TAKEN, "Username already taken."};
+    Donor* newDonor = new Donor();
+    static_cast<DonorInput&>(*newDonor) = std::move(input);
+    newDonor->next = nullptr;
+    addDonor(newDonor);
+    if (created) *created = newDonor;
+    return {BANK_OK, "Donor registered successfully!"};
+}
+
+LoginResult login(const string& username, const string& password) {
+    Donor* donor;
+    {
+        lock_guard<mutex> lock(storeMutex);
+        donor = authenticateDonor(username, password);
+    }
+    if (donor == nullptr) return {BANK_BAD_CREDENTIALS, nullptr, ""};
+    return {BANK_OK, donor, sessions.create(SessionState{donor, false})};
+}
+
+LoginResult supervisorLogin(const string& username, const string& password) {
+    if (!isSupervisor(username, password)) return {BANK_BAD_CREDENTIALS, nullptr, ""};
+    return {BANK_OK, nullptr, sessions.create(SessionState{nullptr, true})};
+}
+
+BankResult book(const Donor* donor, const string& date, const string& time, const string& message) {
+    if (!isValidDateFormat(date)) return {BANK_INVALID_INPUT, "Invalid date. Use the YYYY-MM-DD format."};
+    if (!isDateValid(date)) return {BANK_INVALID_INPUT, "Invalid date. Appointment date cannot be in the past."};
+    if (!isValidTimeFormat(time)) return {BANK_INVALID_INPUT, "Invalid time. Use the HH:MM format."};
+
+    lock_guard<mutex> lock(storeMutex);
+    string notEligible = eligibilityError(donor, date);
+    if (!notEligible.empty()) return {BANK_NOT_ELIGIBLE, notEligible};
+    addAppointment(donor->username, date, time, message);
+    return {BANK_OK, "Appointment successfully scheduled for " + date + " at " + time + "."};
+}
+
+// The overview counted from scratch: every donor, appointment and unit
+DashboardSnapshot recomputeDashboard(int today) {
+    DashboardSnapshot out;
+    out.day = today;
+    for (const Donor* d : donors) {
+        int type = Inventory::typeIndex(d->bloodType);
+        int t = type >= 0 ? type : BLOOD_TYPE_COUNT;
+        out.donors++;
+        out.donorsByType[t]++;
+        if (eligibility.isEligibleOn(d->id, today)) {
+            out.eligible++;
+            out.eligibleByType[t]++;
+        }
+    }
+    for (const Appointment* a : appointments) {
+        int day = daysFromDate(a->date);
+        out.appointmentsToday += day == today;
+        out.appointmentsThisWeek += day >= today && day < today + 7;
+    }
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) out.stockByType[t] = inventory.countUsable(t, today);
+    return out;
+}
+
+// Today's overview; with --check-dashboard it is also recounted and any
+// difference is printed (and returned in `differences`, if given)
+DashboardSnapshot readDashboard(vector<string>* differences = nullptr) {
+    TIME_OPERATION("bloodbank_read_dashboard");
+    int today = daysFromDate(getCurrentDate());
+    DashboardSnapshot snapshot = dashboard.read(today);
+    if (checkDashboard || differences) {
+        vector<string> diff = dashboardDifferences(snapshot, recomputeDashboard(today));
+        for (const string& line : diff) cout << "❌ Dashboard mismatch, " << line << " (live vs recount)\n";
+        if (differences) *differences = diff;
+    }
+    return snapshot;
+}
+
 // Function declarations
 void donorDashboard();
 
-void registerDonor();
+void registerDonorPrompt();
 void donorLoginAndDashboard();
 void makeAppointment(const Donor* currentDonor);
 
 void supervisorDashboard();
+void printOverview();
 void viewDonors();
+void exportDonorsPrompt();
+void searchDonors();
+void donorsNearLocation();
+void donorStatistics();
 void sendMedicalHistory();
 void sendHealthStatus();
+void cohortQuery();
+void becomingEligibleThisWeek();
+void viewBloodStock();
+void issueBloodUnits();
+void sendRemindersForTomorrow();
+void viewMedicalHistory(const Donor* donor);
+void viewHealthStatus(const Donor* donor);
 void mainMenu();
 
 void mainMenu() {
@@ -183,7 +454,7 @@ void donorDashboard() {
         switch (choice) {
             case 1:
                 cout << "[Register Functionality will be here]\n";
-                registerDonor();
+                registerDonorPrompt();
                 break;
             case 2:
                 cout << "[Login Functionality will be here]\n";
@@ -200,119 +471,120 @@ void donorDashboard() {
         }
     } while (true);
 }
-void registerDonor() {
-    Donor* newDonor = new Donor();
+void registerDonorPrompt() {
+    DonorInput input;
 
     cout << "\n--- Donor Registration ---\n";
 
     // First name
     do {
         cout << "First Name: ";
-        cin >> newDonor->firstName;
-        if (!isAlphaString(newDonor->firstName))
+        cin >> input.firstName;
+        if (!isAlphaString(input.firstName))
             cout << "❌ Invalid first name. Use letters only.\n";
-    } while (!isAlphaString(newDonor->firstName));
+    } while (!isAlphaString(input.firstName));
 
     // Last name
     do {
         cout << "Last Name: ";
-        cin >> newDonor->lastName;
-        if (!isAlphaString(newDonor->lastName))
+        cin >> input.lastName;
+        if (!isAlphaString(input.lastName))
             cout << "❌ Invalid last name. Use letters only.\n";
-    } while (!isAlphaString(newDonor->lastName));
+    } while (!isAlphaString(input.lastName));
 
     // Gender
     do {
         cout << "Gender (male/female): ";
-        cin >> newDonor->gender;
-        if (!isValidGender(newDonor->gender))
+        cin >> input.gender;
+        if (!isValidGender(input.gender))
             cout << "❌ Invalid gender. Enter 'male' or 'female'.\n";
-    } while (!isValidGender(newDonor->gender));
+    } while (!isValidGender(input.gender));
 
     // Phone number
     do {
         cout << "Phone Number (start with 09 or 07, 10 digits): ";
-        cin >> newDonor->phone;
-        if (!isValidPhone(newDonor->phone))
+        cin >> input.phone;
+        if (!isValidPhone(input.phone))
             cout << "❌ Invalid phone number.\n";
-    } while (!isValidPhone(newDonor->phone));
+    } while (!isValidPhone(input.phone));
 
     // Username
+    bool taken = false;
     do {
         cout << "Username: ";
-        cin >> newDonor->username;
-        if (newDonor->username.empty())
+        cin >> input.username;
+        taken = findDonorByUsername(input.username) != nullptr;
+        if (input.username.empty())
             cout << "❌ Username cannot be empty.\n";
-    } while (newDonor->username.empty());
+        else if (taken)
+            cout << "❌ Username already taken.\n";
+    } while (input.username.empty() || taken);
 
     // Password + confirm password
     string confirmPass;
     do {
         cout << "Password (min 7 chars): ";
-        cin >> newDonor->password;
-        if (!isValidPassword(newDonor->password)) {
+        cin >> input.password;
+        if (!isValidPassword(input.password)) {
             cout << "❌ Password too short.\n";
             continue;
         }
         cout << "Confirm Password: ";
         cin >> confirmPass;
-        if (confirmPass != newDonor->password)
+        if (confirmPass != input.password)
             cout << "❌ Passwords do not match.\n";
-    } while (!isValidPassword(newDonor->password) || confirmPass != newDonor->password);
+    } while (!isValidPassword(input.password) || confirmPass != input.password);
 
     // Blood type (optional)
     do {
         cout << "Blood Type (optional, e.g., A, B+, O-): ";
-        cin >> newDonor->bloodType;
-        if (!isValidBloodType(newDonor->bloodType))
+        cin >> input.bloodType;
+        if (!isValidBloodType(input.bloodType))
             cout << "❌ Invalid blood type.\n";
-    } while (!isValidBloodType(newDonor->bloodType));
+    } while (!isValidBloodType(input.bloodType));
 
     // Email (optional)
     do {
         cout << "Email (optional): ";
-        cin >> newDonor->email;
-        if (!isValidEmail(newDonor->email))
+        cin >> input.email;
+        if (!isValidEmail(input.email))
             cout << "❌ Invalid email format.\n";
-    } while (!isValidEmail(newDonor->email));
+    } while (!isValidEmail(input.email));
 
     // City
     do {
         cout << "City: ";
-        cin >> newDonor->city;
-        if (!isAlphaString(newDonor->city))
+        cin >> input.city;
+        if (!isAlphaString(input.city))
             cout << "❌ Invalid city. Use letters only.\n";
-    } while (!isAlphaString(newDonor->city));
+    } while (!isAlphaString(input.city));
 
     // Region
     do {
         cout << "Region: ";
-        cin >> newDonor->region;
-        if (!isAlphaString(newDonor->region))
+        cin >> input.region;
+        if (!isAlphaString(input.region))
             cout << "❌ Invalid region. Use letters only.\n";
-    } while (!isAlphaString(newDonor->region));
+    } while (!isAlphaString(input.region));
 
     // Kebele
     do {
         cout << "Kebele: ";
-        cin >> newDonor->kebele;
-        if (!isAlphaString(newDonor->kebele))
+        cin >> input.kebele;
+        if (!isAlphaString(input.kebele))
             cout << "❌ Invalid kebele. Use letters only.\n";
-    } while (!isAlphaString(newDonor->kebele));
+    } while (!isAlphaString(input.kebele));
 
     // Worda
     do {
         cout << "Worda: ";
-        cin >> newDonor->worda;
-        if (!isAlphaString(newDonor->worda))
+        cin >> input.worda;
+        if (!isAlphaString(input.worda))
             cout << "❌ Invalid worda. Use letters only.\n";
-    } while (!isAlphaString(newDonor->worda));
+    } while (!isAlphaString(input.worda));
 
-    // Add new donor to front of list
-    newDonor->next = donorHead;
-    donorHead = newDonor;
-
-    cout << "✅ Donor registered successfully!\n";
+    BankResult result = registerDonor(std::move(input));
+    cout << (result.ok() ? "✅ " : "❌ ") << result.message << "\n";
 }
 void donorLoginAndDashboard() {
     string username, password;
@@ -324,52 +596,55 @@ void donorLoginAndDashboard() {
     cout << "Password: ";
     cin >> password;
 
-    Donor* current = donorHead;
-    while (current != nullptr) {
-        if (current->username == username && current->password == password) {
-            cout << "✅ Login successful! Welcome, " << current->firstName << "!\n";
-
-            // Start donor dashboard loop
-            int choice;
-            do {
-                cout << "\n--- Donor Dashboard ---\n";
-                cout << "Welcome, " << current->firstName << " " << current->lastName << "!\n";
-                cout << "1. Make Appointment\n2. View Medical Health\n3. View Health Status\n4. Logout (Back to Donor Menu)\n5. Exit\n";
-                cout << "Choice: ";
-                cin >> choice;
-
-                switch (choice) {
-                    case 1:
-                        // TODO: Implement appointment function
-                        cout << "Make Appointment selected (not implemented yet).\n";
-                        makeAppointment(current);
-
-                        break;
-                    case 2:
-                        // TODO: Implement medical health view function
-                        cout << "View Medical Health selected (not implemented yet).\n";
-                        break;
-                    case 3:
-                        // TODO: Implement health status view function
-                        cout << "View Health Status selected (not implemented yet).\n";
-                        break;
-                    case 4:
-                        cout << "Logging out...\n";
-                        break;
-                    case 5:
-                        cout << "Exiting...\n";
-                        exit(0);
-                    default:
-                        cout << "Invalid choice.\n";
-                }
-            } while (choice != 4);
-
-            return; // Exit after logout
-        }
-        current = current->next;
-    }
-
-    cout << "❌ Invalid username or password.\n";
+    LoginResult session = login(username, password);
+    if (session.status != BANK_OK) {
+        cout << "❌ Invalid username or password.\n";
+        return;
+    }
+
+    string token = session.token;
+    cout << "✅ Login successful! Welcome, " << session.donor->firstName << "!\n";
+
+    // Start donor dashboard loop
+    int choice;
+    do {
+        SessionState state;
+        if (!sessions.lookup(token, state)) {
+            cout << "⌛ Session expired. Please log in again.\n";
+            return;
+        }
+        Donor* current = state.donor;
+
+        cout << "\n--- Donor Dashboard ---\n";
+        cout << "Welcome, " << current->firstName << " " << current->lastName << "!\n";
+        cout << "1. Make Appointment\n2. View Medical Health\n3. View Health Status\n4. Logout (Back to Donor Menu)\n5. Exit\n";
+        cout << "Choice: ";
+        cin >> choice;
+
+        switch (choice) {
+            case 1:
+                // TODO: Implement appointment function
+                cout << "Make Appointment selected (not implemented yet).\n";
+                makeAppointment(current);
+
+                break;
+            case 2:
+                viewMedicalHistory(current);
+                break;
+            case 3:
+                viewHealthStatus(current);
+                break;
+            case 4:
+                cout << "Logging out...\n";
+                sessions.revoke(token);
+                break;
+            case 5:
+                cout << "Exiting...\n";
+                exit(0);
+            default:
+                cout << "Invalid choice.\n";
+        }
+    } while (choice != 4);
 }
 void makeAppointment(const Donor* currentDonor) {
     string date, time, message;
@@ -379,11 +654,6 @@ void makeAppointment(const Donor* currentDonor) {
     cout << "Enter appointment date (YYYY-MM-DD): ";
     cin >> date;
 
-    if (!isDateValid(date)) {
-        cout << "❌ Invalid date. Appointment date cannot be in the past.\n";
-        return;
-    }
-
     cout << "Enter appointment time (HH:MM, 24-hour): ";
     cin >> time;
 
@@ -391,90 +661,1626 @@ void makeAppointment(const Donor* currentDonor) {
     cin.ignore();  // clear newline
     getline(cin, message);
 
-    addAppointment(currentDonor->username, date, time, message);
-
-    cout << "✅ Appointment successfully scheduled for " << date << " at " << time << ".\n";
+    BankResult result = book(currentDonor, date, time, message);
+    cout << (result.ok() ? "✅ " : "❌ ") << result.message << "\n";
 }
 
 
 void supervisorDashboard() {
     cout << "\n--- Welcome to Supervisor Dashboard ---\n";
-    // You can add supervisor options here later
-     string username, password;
 
-    cout << "\n--- Supervisor Login ---\n";
-    cout << "Username: ";
-    cin >> username;
-    cout << "Password: ";
-    cin >> password;
+    // Reuse the supervisor session if it is still alive
+    SessionState state;
+    if (sessions.lookup(supervisorToken, state) && state.supervisor) {
+        cout << "✅ Welcome back, supervisor.\n";
+    } else {
+        string username, password;
 
-    if (username == "sup1" && password == "sup123456") {
+        cout << "\n--- Supervisor Login ---\n";
+        cout << "Username: ";
+        cin >> username;
+        cout << "Password: ";
+        cin >> password;
+
+        LoginResult session = supervisorLogin(username, password);
+        if (session.status != BANK_OK) {
+            cout << "❌ Invalid username or password.\n";
+            return;
+        }
+        supervisorToken = session.token;
         cout << "✅ Supervisor login successful!\n";
-
-        int choice;
-        do {
-            cout << "\n--- Supervisor Dashboard ---\n";
-            cout << "1. View Donors\n";
-            cout << "2. Send Medical History\n";
-            cout << "3. Send Health Status\n";
-            cout << "4. Logout (Back to Supervisor Menu)\n";
-            cout << "5. Exit\n";
-            cout << "Choice: ";
-            cin >> choice;
-
-            switch (choice) {
-                case 1:
-                    viewDonors();
-                    break;
-                case 2:
-                    sendMedicalHistory();
-                    break;
-                case 3:
-                    sendHealthStatus();
-                    break;
-                case 4:
-                    cout << "Logging out...\n";
-                    break;
-                case 5:
-                    cout << "Exiting...\n";
-                    exit(0);
-                default:
-                    cout << "Invalid choice.\n";
-            }
-        } while (choice != 4);
-    } else {
-        cout << "❌ Invalid username or password.\n";
     }
+
+    int choice;
+    do {
+        if (!sessions.isValid(supervisorToken)) {
+            cout << "⌛ Session expired. Please log in again.\n";
+            return;
+        }
+
+        cout << "\n--- Supervisor Dashboard ---\n";
+        printOverview();
+        cout << "1. View Donors\n";
+        cout << "2. Send Medical History\n";
+        cout << "3. Send Health Status\n";
+        cout << "4. Cohort Query (low hemoglobin / flags)\n";
+        cout << "5. Donors Becoming Eligible This Week\n";
+        cout << "6. Blood Stock\n";
+        cout << "7. Issue Blood Units\n";
+        cout << "8. Send Appointment Reminders (tomorrow)\n";
+        cout << "9. Export Donors (CSV / JSONL / columnar)\n";
+        cout << "10. Search Donors (name / location)\n";
+        cout << "11. Donors Near a Location (emergency drive)\n";
+        cout << "12. Donor Statistics (gender / blood type / area / month)\n";
+        cout << "13. Back to Main Menu (stay logged in)\n";
+        cout << "14. Logout\n";
+        cout << "15. Exit\n";
+        cout << "Choice: ";
+        cin >> choice;
+
+        switch (choice) {
+            case 1:
+                viewDonors();
+                break;
+            case 2:
+                sendMedicalHistory();
+                break;
+            case 3:
+                sendHealthStatus();
+                break;
+            case 4:
+                cohortQuery();
+                break;
+            case 5:
+                becomingEligibleThisWeek();
+                break;
+            case 6:
+                viewBloodStock();
+                break;
+            case 7:
+                issueBloodUnits();
+                break;
+            case 8:
+                sendRemindersForTomorrow();
+                break;
+            case 9:
+                exportDonorsPrompt();
+                break;
+            case 10:
+                searchDonors();
+                break;
+            case 11:
+                donorsNearLocation();
+                break;
+            case 12:
+                donorStatistics();
+                break;
+            case 13:
+                break;
+            case 14:
+                cout << "Logging out...\n";
+                sessions.revoke(supervisorToken);
+                supervisorToken.clear();
+                break;
+            case 15:
+                cout << "Exiting...\n";
+                exit(0);
+            default:
+                cout << "Invalid choice.\n";
+        }
+    } while (choice != 13 && choice != 14);
 }
 void viewDonors() {
+    TIME_OPERATION("bloodbank_view_donors");
     cout << "\n--- List of Donors ---\n";
 
-    Donor* current = donorHead;
-    if (!current) {
+    // Snapshot read, newest first like the list
+    auto snap = donorVersions.snapshot();
+    if (snap.size() == 0) {
         cout << "No donors registered yet.\n";
         return;
     }
 
-    while (current != nullptr) {
-        cout << "Name: " << current->firstName << " " << current->lastName
-             << ", Username: " << current->username
-             << ", Phone: " << current->phoneNumber << "\n";
-        current = current->next;
+    for (size_t id = snap.size(); id-- > 0;) {
+        const Donor* const* current = snap.get(id);
+        if (!current) continue;
+        cout << "Name: " << (*current)->firstName << " " << (*current)->lastName
+             << ", Username: " << (*current)->username
+             << ", Phone: " << (*current)->phone << "\n";
+    }
+}
+
+// Writes every donor (without passwords) to fd from a snapshot, oldest
+// first. Strings go out straight from the donor records.
+bool exportDonors(int fd, ExportFormat format) {
+    TIME_OPERATION("bloodbank_export_donors");
+    static const vector<ExportColumn> columns = {
+        {"id", COLUMN_INT}, {"firstName", COLUMN_STRING}, {"lastName", COLUMN_STRING},
+        {"gender", COLUMN_STRING}, {"phone", COLUMN_STRING}, {"username", COLUMN_STRING},
+        {"bloodType", COLUMN_STRING}, {"email", COLUMN_STRING}, {"city", COLUMN_STRING},
+        {"region", COLUMN_STRING}, {"kebele", COLUMN_STRING}, {"worda", COLUMN_STRING},
+        {"registeredOn", COLUMN_STRING}};
+    auto snap = donorVersions.snapshot();
+    ExportWriter out(fd, format, columns);
+    for (size_t id = 0; id < snap.size(); id++) {
+        const Donor* const* row = snap.get(id);
+        if (!row) continue;
+        const Donor* d = *row;
+        out.field(d->id);
+        out.field(d->firstName);
+        out.field(d->lastName);
+        out.field(d->gender);
+        out.field(d->phone);
+        out.field(d->username);
+        out.field(d->bloodType);
+        out.field(d->email);
+        out.field(d->city);
+        out.field(d->region);
+        out.field(d->kebele);
+        out.field(d->worda);
+        out.field(d->registeredOn);
+    }
+    return out.finish();
+}
+
+// Fuzzy lookup over names, city, kebele and worda; tolerates misspellings
+void searchDonors() {
+    TIME_OPERATION("bloodbank_search_donors");
+    string text;
+    cout << "\n--- Search Donors ---\n";
+    cout << "Search for (e.g. Abebe Bahir Dar): ";
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    getline(cin, text);
+
+    vector<DonorSearchIndex::Match> matches = donorSearch.search(text, 10);
+    if (matches.empty()) {
+        cout << "No donors match.\n";
+        return;
+    }
+    for (const DonorSearchIndex::Match& m : matches) {
+        const Donor* d = donorsById[m.id];
+        cout << "Name: " << d->firstName << " " << d->lastName << ", Username: " << d->username
+             << ", City: " << d->city << ", Kebele: " << d->kebele << ", Worda: " << d->worda
+             << ", Match: " << static_cast<int>(m.score * 100 + 0.5f) << "%\n";
+    }
+}
+
+// Donors in a kebele first, then the rest of its worda, city and region
+void donorsNearLocation() {
+    TIME_OPERATION("bloodbank_donors_near");
+    static const char* levelNames[LEVEL_COUNT] = {"Region", "City", "Worda", "Kebele"};
+    cout << "\n--- Donors Near a Location ---\n";
+    string path[LEVEL_COUNT];
+    for (int level = 0; level < LEVEL_COUNT; level++) {
+        cout << levelNames[level] << (level == 0 ? ": " : " ('-' to stop here): ");
+        cin >> path[level];
+        if (path[level] == "-") {
+            path[level].clear();
+            break;
+        }
+    }
+    int node = locations.find(path[LEVEL_REGION], path[LEVEL_CITY], path[LEVEL_WORDA], path[LEVEL_KEBELE]);
+    if (node < 0) {
+        cout << "❌ No donors registered in that area.\n";
+        return;
+    }
+
+    string bloodType;
+    cout << "Blood type (A+, A-, B+, B-, AB+, AB-, O+, O-, '-' for any): ";
+    cin >> bloodType;
+    unsigned typeMask = LocationIndex::allTypes;
+    if (bloodType != "-") {
+        int type = Inventory::typeIndex(bloodType);
+        if (type < 0) {
+            cout << "❌ Invalid blood type.\n";
+            return;
+        }
+        typeMask = 1u << type;
+    }
+    int wanted;
+    cout << "How many donors? ";
+    cin >> wanted;
+    if (cin.fail() || wanted <= 0) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "❌ Invalid number of donors.\n";
+        return;
+    }
+
+    // Donors per area along the path, by blood type
+    cout << left << setw(24) << "Area" << right;
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) cout << setw(5) << Inventory::typeName(t);
+    cout << setw(7) << "Total" << "\n";
+    for (int n = node; n >= 0; n = locations.parent(n)) {
+        cout << left << setw(24) << (string(levelNames[locations.level(n)]) + " " + locations.name(n)) << right;
+        for (int t = 0; t < BLOOD_TYPE_COUNT; t++) cout << setw(5) << locations.count(n, t);
+        cout << setw(7) << locations.total(n) << "\n";
+    }
+
+    vector<LocationIndex::Nearby> found = locations.nearest(node, wanted, typeMask);
+    if (found.empty()) {
+        cout << "No matching donors in the region.\n";
+        return;
+    }
+    int area = locations.level(node);
+    for (const LocationIndex::Nearby& n : found) {
+        const Donor* d = donorsById[n.donorId];
+        cout << "Name: " << d->firstName << " " << d->lastName << ", Phone: " << d->phone
+             << ", Blood Type: " << d->bloodType << ", Kebele: " << d->kebele << ", Worda: " << d->worda
+             << ", City: " << d->city << " (same " << levelNames[area - n.widened] << ")\n";
+    }
+    if (static_cast<int>(found.size()) < wanted) {
+        cout << "⚠️ Only " << found.size() << " of " << wanted << " donor(s) found in the region.\n";
+    }
+}
+
+// Donor counts for any mix of gender, blood type, region, city and registration month
+void donorStatistics() {
+    TIME_OPERATION("bloodbank_donor_statistics");
+    static const char* prompts[ATTR_COUNT] = {"Gender", "Blood type", "Region", "City"};
+    cout << "\n--- Donor Statistics ---\n";
+    cout << "Enter '-' for any.\n";
+    DonorFilter filter;
+    for (int a = 0; a < ATTR_COUNT; a++) {
+        cout << prompts[a] << ": ";
+        cin >> filter.values[a];
+        if (filter.values[a] == "-") filter.values[a].clear();
+    }
+    cout << "Registered from month (YYYY-MM): ";
+    cin >> filter.fromMonth;
+    cout << "Registered to month (YYYY-MM): ";
+    cin >> filter.toMonth;
+    if (filter.fromMonth == "-") filter.fromMonth.clear();
+    if (filter.toMonth == "-") filter.toMonth.clear();
+
+    cout << "Matching donors: " << donorAttributes.count(filter) << " of " << donorAttributes.size() << "\n";
+    for (const auto& entry : donorAttributes.countBy(filter, ATTR_BLOOD_TYPE)) {
+        cout << "  " << left << setw(6) << entry.first << right << entry.second << "\n";
+    }
+}
+
+void exportDonorsPrompt() {
+    string formatName, path;
+    cout << "\n--- Export Donors ---\n";
+    cout << "Format (csv / jsonl / columnar): ";
+    cin >> formatName;
+    ExportFormat format;
+    if (!exportFormatFromName(formatName, format)) {
+        cout << "❌ Unknown format.\n";
+        return;
+    }
+    cout << "Output file: ";
+    cin >> path;
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cout << "❌ Could not open " << path << ".\n";
+        return;
     }
+    bool ok = exportDonors(fd, format);
+    close(fd);
+    if (ok) cout << "✅ Donors exported to " << path << ".\n";
+    else cout << "❌ Export failed.\n";
 }
 
+// ---- Medical history and health status ----
+
+// Parses "13.5" into tenths of g/dL; "-" means not measured
+bool parseHemoglobin(const string& s, int& out) {
+    if (s == "-") {
+        out = 0;
+        return true;
+    }
+    char* end = nullptr;
+    double value = strtod(s.c_str(), &end);
+    if (end == s.c_str() || *end != '\0' || !isfinite(value) || value < 3 || value > 25) return false;
+    out = static_cast<int>(value * 10 + 0.5);
+    return true;
+}
+
+// Parses "120/80" into systolic/diastolic; "-" means not measured
+bool parseBloodPressure(const string& s, int& systolic, int& diastolic) {
+    if (s == "-") {
+        systolic = diastolic = 0;
+        return true;
+    }
+    int used = 0;
+    if (sscanf(s.c_str(), "%d/%d%n", &systolic, &diastolic, &used) != 2 || used != static_cast<int>(s.size())) return false;
+    return systolic >= 50 && systolic <= 260 && diastolic >= 30 && diastolic <= 160 && diastolic < systolic;
+}
+
+string formatHemoglobin(int tenths) {
+    if (tenths == 0) return "-";
+    return to_string(tenths / 10) + "." + to_string(tenths % 10) + " g/dL";
+}
+
+string formatBloodPressure(int systolic, int diastolic) {
+    if (systolic == 0) return "-";
+    return to_string(systolic) + "/" + to_string(diastolic) + " mmHg";
+}
+
+string describeFlags(uint8_t flags) {
+    static const pair<HealthFlag, const char*> names[] = {
+        {FLAG_DONATED, "donated"},
+        {FLAG_LOW_HEMOGLOBIN, "low hemoglobin"},
+        {FLAG_HIGH_BLOOD_PRESSURE, "high blood pressure"},
+        {FLAG_ILLNESS, "illness"},
+        {FLAG_MEDICATION, "medication"},
+        {FLAG_TRAVEL, "travel"},
+        {FLAG_PERMANENT_DEFERRAL, "permanent deferral"}};
+    string out;
+    for (const auto& n : names) {
+        if (flags & n.first) {
+            if (!out.empty()) out += ", ";
+            out += n.second;
+        }
+    }
+    return out.empty() ? "none" : out;
+}
+
+// Screening values below/above these raise the matching deferral flag
+const int MIN_HEMOGLOBIN = 125; // 12.5 g/dL
+const int MAX_SYSTOLIC = 180;
+const int MAX_DIASTOLIC = 100;
+
+uint8_t screeningFlags(const HealthReading& r) {
+    uint8_t flags = 0;
+    if (r.hemoglobin > 0 && r.hemoglobin < MIN_HEMOGLOBIN) flags |= FLAG_LOW_HEMOGLOBIN;
+    if (r.systolic > MAX_SYSTOLIC || r.diastolic > MAX_DIASTOLIC) flags |= FLAG_HIGH_BLOOD_PRESSURE;
+    return flags;
+}
+
+// ---- Notifications ----
+
+// SMS goes to the outbox an SMS gateway reads from, email likewise
+void setupNotifications() {
+    notifications.setSink(CHANNEL_SMS, unique_ptr<NotificationSink>(new FileSink("sms_outbox.txt")));
+    notifications.setSink(CHANNEL_EMAIL, unique_ptr<NotificationSink>(new FileSink("email_outbox.txt")));
+}
+
+// Queues a message to a donor by SMS, and by email if they gave one
+void notifyDonor(const Donor* donor, const string& text) {
+    notifications.sendNow(Notification{CHANNEL_SMS, donor->phone, text});
+    if (!donor->email.empty()) notifications.sendNow(Notification{CHANNEL_EMAIL, donor->email, text});
+}
+
+// Reminds every donor with an appointment on the given day. Only the day's
+// bucket of the time index is read, and running it again for the same day
+// only reminds appointments booked since the last run.
+// Returns the number of appointments reminded.
+int sendAppointmentReminders(int day) {
+    TIME_OPERATION("bloodbank_send_reminders");
+    if (day < remindersSentForDay) return 0;
+    if (day > remindersSentForDay) {
+        remindersSentForDay = day;
+        remindersSentCount = 0;
+    }
+
+    int reminded = 0;
+    auto it = appointmentsByDay.find(day);
+    if (it != appointmentsByDay.end()) {
+        for (; remindersSentCount < it->second.size(); remindersSentCount++) {
+            const Appointment* a = it->second[remindersSentCount];
+            const Donor* donor = findDonorByUsername(a->donorUsername);
+            if (donor == nullptr) continue;
+            string text = "Reminder: your blood donation appointment is on " + a->date + " at " + a->time + ".";
+            if (!a->message.empty()) text += " Note: " + a->message;
+            notifyDonor(donor, text);
+            reminded++;
+        }
+    }
+    return reminded;
+}
+
+// Reads a blood component choice, or returns -1 after printing why
+int promptComponent() {
+    int choice;
+    cout << "Component (1. Whole blood, 2. Red cells, 3. Platelets, 4. Plasma): ";
+    cin >> choice;
+    if (cin.fail() || choice < 1 || choice > COMPONENT_COUNT) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "❌ Invalid component.\n";
+        return -1;
+    }
+    return choice - 1;
+}
+
+// Reads a username and returns the donor, or nullptr after printing why
+Donor* promptDonor() {
+    string username;
+    cout << "Donor username: ";
+    cin >> username;
+    Donor* donor = findDonorByUsername(username);
+    if (donor == nullptr) cout << "❌ No donor with that username.\n";
+    return donor;
+}
+
+// Reads a YYYY-MM-DD date ("today" for the current date)
+bool promptDate(const string& label, string& date) {
+    cout << label << " (YYYY-MM-DD or 'today'): ";
+    cin >> date;
+    if (date == "today") date = getCurrentDate();
+    if (!isValidDateFormat(date)) {
+        cout << "❌ Invalid date. Use the YYYY-MM-DD format.\n";
+        return false;
+    }
+    return true;
+}
+
+// Supervisor records a screening visit (hemoglobin, blood pressure, donation)
 void sendMedicalHistory() {
     cout << "\n--- Send Medical History ---\n";
-    // To be implemented
+
+    Donor* donor = promptDonor();
+    if (donor == nullptr) return;
+
+    string date, hb, bp, donated;
+    if (!promptDate("Visit date", date)) return;
+
+    HealthReading reading;
+    reading.day = daysFromDate(date);
+
+    cout << "Hemoglobin in g/dL (e.g. 13.5, '-' if not measured): ";
+    cin >> hb;
+    if (!parseHemoglobin(hb, reading.hemoglobin)) {
+        cout << "❌ Invalid hemoglobin value.\n";
+        return;
+    }
+
+    cout << "Blood pressure (e.g. 120/80, '-' if not measured): ";
+    cin >> bp;
+    if (!parseBloodPressure(bp, reading.systolic, reading.diastolic)) {
+        cout << "❌ Invalid blood pressure.\n";
+        return;
+    }
+
+    cout << "Donation taken at this visit? (y/n): ";
+    cin >> donated;
+    int component = -1;
+    int type = -1;
+    if (donated == "y" || donated == "Y") {
+        reading.flags |= FLAG_DONATED;
+        component = promptComponent();
+        if (component < 0) return;
+        type = unitBloodType(donor, "");
+        if (type < 0) {
+            // Registered as e.g. "A" or with no type: the unit needs its full type for stock
+            string given;
+            cout << "Donor's full blood type is unknown. Blood type of the unit (e.g. A+): ";
+            cin >> given;
+            type = unitBloodType(donor, given);
+            if (type < 0) {
+                cout << "❌ Invalid blood type for this donor.\n";
+                return;
+            }
+        }
+    }
+    reading.flags |= screeningFlags(reading);
+
+    recordHealth(donor, reading);
+    cout << "✅ Medical history recorded for " << donor->firstName << " " << donor->lastName
+         << " (flags: " << describeFlags(reading.flags) << ").\n";
+
+    if (component >= 0) {
+        int unitId = receiveUnit(donor, type, static_cast<Component>(component), reading.day);
+        cout << "✅ Unit #" << unitId << " (" << Inventory::typeName(type) << ", " << Inventory::componentName(component)
+             << ") added to stock.\n";
+    }
 }
 
+// Supervisor records a health status change (deferral reasons)
 void sendHealthStatus() {
     cout << "\n--- Send Health Status ---\n";
-    // To be implemented
+
+    Donor* donor = promptDonor();
+    if (donor == nullptr) return;
+
+    string date;
+    if (!promptDate("Status date", date)) return;
+
+    cout << "Status flags (space separated, 0 to finish):\n";
+    cout << "1. Illness\n2. Medication\n3. Travel\n4. Permanent deferral\n";
+    HealthReading reading;
+    reading.day = daysFromDate(date);
+    int option;
+    while (cin >> option && option != 0) {
+        switch (option) {
+            case 1: reading.flags |= FLAG_ILLNESS; break;
+            case 2: reading.flags |= FLAG_MEDICATION; break;
+            case 3: reading.flags |= FLAG_TRAVEL; break;
+            case 4: reading.flags |= FLAG_PERMANENT_DEFERRAL; break;
+            default: cout << "❌ Unknown flag " << option << " ignored.\n";
+        }
+    }
+    if (cin.fail()) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "❌ Invalid input.\n";
+        return;
+    }
+
+    recordHealth(donor, reading);
+    notifyDonor(donor, "Health status update (" + date + "): " + describeFlags(reading.flags) + ".");
+    notifications.tick();
+    cout << "✅ Health status sent to " << donor->firstName << " " << donor->lastName
+         << " (" << describeFlags(reading.flags) << ").\n";
+}
+
+// Supervisor lists donors with low hemoglobin and/or flags in the last N days
+void cohortQuery() {
+    cout << "\n--- Cohort Query ---\n";
+
+    int days;
+    string hb;
+    cout << "Look back how many days (1-3650)? ";
+    cin >> days;
+    if (cin.fail() || days < 1 || days > 3650) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "❌ Invalid number of days.\n";
+        return;
+    }
+    cout << "Hemoglobin below g/dL ('-' for any): ";
+    cin >> hb;
+
+    CohortQuery q;
+    q.toDay = daysFromDate(getCurrentDate());
+    q.fromDay = q.toDay - days;
+    if (!parseHemoglobin(hb, q.hemoglobinBelow)) {
+        cout << "❌ Invalid hemoglobin value.\n";
+        return;
+    }
+
+    vector<int> ids = healthStore.cohort(q);
+    if (ids.empty()) {
+        cout << "No donors match.\n";
+        return;
+    }
+    for (int id : ids) {
+        const Donor* d = donorsById[id];
+        HealthReading last;
+        healthStore.latest(id, last);
+        cout << "Name: " << d->firstName << " " << d->lastName << ", Username: " << d->username
+             << ", Blood Type: " << d->bloodType << ", Latest Hb: " << formatHemoglobin(last.hemoglobin) << "\n";
+    }
+    cout << ids.size() << " donor(s) found.\n";
+}
+
+// Supervisor lists donors whose deferral ends within the next 7 days
+void becomingEligibleThisWeek() {
+    cout << "\n--- Donors Becoming Eligible This Week ---\n";
+    int today = daysFromDate(getCurrentDate());
+    vector<int> ids = eligibility.becomingEligible(today, today + 6);
+    if (ids.empty()) {
+        cout << "No donors become eligible this week.\n";
+        return;
+    }
+    for (int id : ids) {
+        const Donor* d = donorsById[id];
+        cout << "Name: " << d->firstName << " " << d->lastName << ", Username: " << d->username
+             << ", Blood Type: " << d->bloodType << ", Eligible from: "
+             << dateFromDays(eligibility.nextEligibleDay(id)) << "\n";
+    }
+    cout << ids.size() << " donor(s) found.\n";
+}
+
+// ---- Blood stock ----
+
+// Live counts shown above the supervisor menu
+void printOverview() {
+    DashboardSnapshot s = readDashboard();
+    cout << "Donors: " << s.donors << " (" << s.eligible << " eligible today)"
+         << " | Appointments today: " << s.appointmentsToday << ", this week: " << s.appointmentsThisWeek << "\n";
+    cout << left << setw(10) << "" << right;
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) cout << setw(5) << Inventory::typeName(t);
+    cout << "\n" << left << setw(10) << "Donors" << right;
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) cout << setw(5) << s.donorsByType[t];
+    cout << "\n" << left << setw(10) << "Eligible" << right;
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) cout << setw(5) << s.eligibleByType[t];
+    cout << "\n" << left << setw(10) << "Stock" << right;
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) cout << setw(5) << s.stockByType[t];
+    cout << "\n";
+}
+
+void viewBloodStock() {
+    cout << "\n--- Blood Stock ---\n";
+    int today = daysFromDate(getCurrentDate());
+    int expired = inventory.expire(today);
+    if (expired > 0) cout << "🗑️ " << expired << " expired unit(s) removed.\n";
+
+    cout << left << setw(6) << "Type" << right << setw(7) << "Whole" << setw(6) << "Red"
+         << setw(11) << "Platelets" << setw(8) << "Plasma" << setw(7) << "Total" << "\n";
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) {
+        cout << left << setw(6) << Inventory::typeName(t) << right
+             << setw(7) << inventory.stock(t, WHOLE_BLOOD) << setw(6) << inventory.stock(t, RED_CELLS)
+             << setw(11) << inventory.stock(t, PLATELETS) << setw(8) << inventory.stock(t, PLASMA)
+             << setw(7) << inventory.stockOfType(t) << "\n";
+    }
 }
 
+void issueBloodUnits() {
+    cout << "\n--- Issue Blood Units ---\n";
+    string bloodType;
+    cout << "Blood type (A+, A-, B+, B-, AB+, AB-, O+, O-): ";
+    cin >> bloodType;
+    int type = Inventory::typeIndex(bloodType);
+    if (type < 0) {
+        cout << "❌ Invalid blood type.\n";
+        return;
+    }
+    int component = promptComponent();
+    if (component < 0) return;
+
+    int count;
+    cout << "Number of units: ";
+    cin >> count;
+    if (cin.fail() || count <= 0) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "❌ Invalid number of units.\n";
+        return;
+    }
+
+    vector<BloodUnit> units = issueUnits(type, static_cast<Component>(component), count);
+    for (const auto& u : units) {
+        cout << "Issued unit #" << u.unitId << ", expires " << dateFromDays(u.expiryDay) << "\n";
+    }
+    if (static_cast<int>(units.size()) < count) {
+        cout << "⚠️ Only " << units.size() << " of " << count << " unit(s) were in stock.\n";
+    } else {
+        cout << "✅ " << count << " unit(s) issued.\n";
+    }
+}
+
+void sendRemindersForTomorrow() {
+    cout << "\n--- Appointment Reminders ---\n";
+    int tomorrow = daysFromDate(getCurrentDate()) + 1;
+    int reminded = sendAppointmentReminders(tomorrow);
+    notifications.tick(); // the console has no timer thread delivering
+    cout << "✅ " << reminded << " new reminder(s) sent for appointments on " << dateFromDays(tomorrow) << ".\n";
+
+    PipelineStats stats = notifications.snapshot();
+    cout << "Delivered: " << stats.delivered << ", Retrying: " << stats.retrying
+         << ", Failed attempts: " << stats.failedAttempts << ", Dropped: " << stats.dropped << "\n";
+}
+
+void viewMedicalHistory(const Donor* donor) {
+    cout << "\n--- Medical History ---\n";
+    vector<HealthReading> readings = healthStore.history(donor->id);
+    if (readings.empty()) {
+        cout << "No medical history recorded yet.\n";
+        return;
+    }
+    for (const auto& r : readings) {
+        cout << dateFromDays(r.day) << "  Hb: " << formatHemoglobin(r.hemoglobin)
+             << ", BP: " << formatBloodPressure(r.systolic, r.diastolic)
+             << ", Flags: " << describeFlags(r.flags) << "\n";
+    }
+}
+
+void viewHealthStatus(const Donor* donor) {
+    cout << "\n--- Health Status ---\n";
+    HealthReading last;
+    if (!healthStore.latest(donor->id, last)) {
+        cout << "No health status recorded yet.\n";
+        return;
+    }
+    cout << "Last update: " << dateFromDays(last.day) << "\n";
+    cout << "Status: " << describeFlags(last.flags) << "\n";
+
+    int lastDonation = eligibility.lastDonationDay(donor->id);
+    if (lastDonation != INT_MIN) cout << "Last donation: " << dateFromDays(lastDonation) << "\n";
+    int next = eligibility.nextEligibleDay(donor->id);
+    if (next == INT_MAX) {
+        cout << "Eligibility: permanently deferred\n";
+    } else if (next > daysFromDate(getCurrentDate())) {
+        cout << "Eligibility: can donate again from " << dateFromDays(next) << "\n";
+    } else {
+        cout << "Eligibility: can donate now\n";
+    }
+
+    // Latest measured values may come from an earlier visit than the last status
+    vector<HealthReading> readings = healthStore.history(donor->id);
+    for (auto it = readings.rbegin(); it != readings.rend(); ++it) {
+        if (it->hemoglobin > 0 || it->systolic > 0) {
+            cout << "Latest screening (" << dateFromDays(it->day) << "): Hb " << formatHemoglobin(it->hemoglobin)
+                 << ", BP " << formatBloodPressure(it->systolic, it->diastolic) << "\n";
+            break;
+        }
+    }
+}
+
+// ================= Server mode (HTTP/JSON) =================
+// Same donor and appointment lists as the console menus, served over HTTP.
+// The lists are shared by every event loop, so handlers hold storeMutex.
+
+string donorToJson(const Donor* d) {
+    return JsonObject()
+        .add("username", d->username)
+        .add("firstName", d->firstName)
+        .add("lastName", d->lastName)
+        .add("gender", d->gender)
+        .add("phone", d->phone)
+        .add("bloodType", d->bloodType)
+        .add("email", d->email)
+        .add("city", d->city)
+        .add("region", d->region)
+        .add("kebele", d->kebele)
+        .add("worda", d->worda)
+        .add("registeredOn", d->registeredOn)
+        .str();
+}
+
+string appointmentToJson(const Appointment* a) {
+    return JsonObject()
+        .add("username", a->donorUsername)
+        .add("date", a->date)
+        .add("time", a->time)
+        .add("message", a->message)
+        .str();
+}
+
+void jsonError(HttpResponse& res, int status, const string& message) {
+    res.status = status;
+    res.body = JsonObject().add("error", message).str();
+}
+
+// Returns the session token of an "Authorization: Bearer ..." header
+string bearerToken(const HttpRequest& req) {
+    string auth = req.header("authorization");
+    if (auth.compare(0, 7, "Bearer ") != 0) return "";
+    return auth.substr(7);
+}
+
+// HTTP status for a failed core call
+int httpStatus(BankStatus status) {
+    switch (status) {
+    case BANK_OK:
+        return 200;
+    case BANK_USERNAME_TAKEN:
+        return 409;
+    case BANK_BAD_CREDENTIALS:
+        return 401;
+    default:
+        return 422;
+    }
+}
+
+void handleRegister(const HttpRequest& req, HttpResponse& res) {
+    map<string, string> body;
+    if (!parseJsonObject(req.body, body)) {
+        jsonError(res, 400, "Request body must be a JSON object.");
+        return;
+    }
+
+    DonorInput input;
+    input.firstName = body["firstName"];
+    input.lastName = body["lastName"];
+    input.gender = body["gender"];
+    input.phone = body["phone"];
+    input.username = body["username"];
+    input.password = body["password"];
+    input.bloodType = body["bloodType"];
+    input.email = body["email"];
+    input.city = body["city"];
+    input.region = body["region"];
+    input.kebele = body["kebele"];
+    input.worda = body["worda"];
+
+    const Donor* created = nullptr;
+    BankResult result = registerDonor(std::move(input), &created);
+    if (!result.ok()) {
+        jsonError(res, httpStatus(result.status), result.message);
+        return;
+    }
+    res.status = 201;
+    res.body = donorToJson(created);
+}
+
+void handleLogin(const HttpRequest& req, HttpResponse& res) {
+    map<string, string> body;
+    if (!parseJsonObject(req.body, body)) {
+        jsonError(res, 400, "Request body must be a JSON object.");
+        return;
+    }
+
+    LoginResult session = login(body["username"], body["password"]);
+    if (session.status != BANK_OK) {
+        jsonError(res, 401, "Invalid username or password.");
+        return;
+    }
+    res.body = JsonObject().add("token", session.token).addRaw("donor", donorToJson(session.donor)).str();
+}
+
+void handleSupervisorLogin(const HttpRequest& req, HttpResponse& res) {
+    map<string, string> body;
+    if (!parseJsonObject(req.body, body)) {
+        jsonError(res, 400, "Request body must be a JSON object.");
+        return;
+    }
+    LoginResult session = supervisorLogin(body["username"], body["password"]);
+    if (session.status != BANK_OK) {
+        jsonError(res, 401, "Invalid username or password.");
+        return;
+    }
+    res.body = JsonObject().add("token", session.token).str();
+}
+
+void handleBookAppointment(const Donor* donor, const HttpRequest& req, HttpResponse& res) {
+    map<string, string> body;
+    if (!parseJsonObject(req.body, body)) {
+        jsonError(res, 400, "Request body must be a JSON object.");
+        return;
+    }
+
+    const string& date = body["date"];
+    const string& time = body["time"];
+    BankResult result = book(donor, date, time, body["message"]);
+    if (!result.ok()) {
+        jsonError(res, httpStatus(result.status), result.message);
+        return;
+    }
+    res.status = 201;
+    res.body = JsonObject().add("username", donor->username).add("date", date).add("time", time).str();
+}
+
+void handleListAppointments(const string& username, HttpResponse& res) {
+    string out = "[";
+    for (const Appointment* a : appointments) {
+        if (!username.empty() && a->donorUsername != username) continue;
+        if (out.size() > 1) out += ',';
+        out += appointmentToJson(a);
+    }
+    out += ']';
+    res.body = out;
+}
+
+// Component index from "whole-blood", "red-cells", "platelets" or "plasma"
+int componentFromName(const string& name) {
+    static const char* names[COMPONENT_COUNT] = {"whole-blood", "red-cells", "platelets", "plasma"};
+    for (int c = 0; c < COMPONENT_COUNT; c++) {
+        if (name == names[c]) return c;
+    }
+    return -1;
+}
+
+string healthReadingToJson(const HealthReading& r) {
+    JsonObject o;
+    o.add("date", dateFromDays(r.day));
+    if (r.hemoglobin > 0) o.add("hemoglobin", r.hemoglobin / 10.0);
+    if (r.systolic > 0) o.add("systolic", r.systolic).add("diastolic", r.diastolic);
+    return o.add("flags", describeFlags(r.flags)).str();
+}
+
+void handleHealthRecords(const Donor* donor, HttpResponse& res) {
+    string out = "[";
+    for (const auto& r : healthStore.history(donor->id)) {
+        if (out.size() > 1) out += ',';
+        out += healthReadingToJson(r);
+    }
+    out += ']';
+    res.body = out;
+}
+
+void handleRecordHealth(const HttpRequest& req, HttpResponse& res) {
+    map<string, string> body;
+    if (!parseJsonObject(req.body, body)) {
+        jsonError(res, 400, "Request body must be a JSON object.");
+        return;
+    }
+    const Donor* donor = findDonorByUsername(body["username"]);
+    if (donor == nullptr) return jsonError(res, 404, "No donor with that username.");
+
+    string date = body["date"].empty() ? getCurrentDate() : body["date"];
+    if (!isValidDateFormat(date)) return jsonError(res, 422, "Invalid date. Use the YYYY-MM-DD format.");
+
+    HealthReading reading;
+    reading.day = daysFromDate(date);
+    if (!parseHemoglobin(body["hemoglobin"].empty() ? "-" : body["hemoglobin"], reading.hemoglobin)) {
+        return jsonError(res, 422, "Invalid hemoglobin value.");
+    }
+    if (!parseBloodPressure(body["bloodPressure"].empty() ? "-" : body["bloodPressure"], reading.systolic, reading.diastolic)) {
+        return jsonError(res, 422, "Invalid blood pressure.");
+    }
+    if (body["donated"] == "true") reading.flags |= FLAG_DONATED;
+    if (body["illness"] == "true") reading.flags |= FLAG_ILLNESS;
+    if (body["medication"] == "true") reading.flags |= FLAG_MEDICATION;
+    if (body["travel"] == "true") reading.flags |= FLAG_TRAVEL;
+    if (body["permanentDeferral"] == "true") reading.flags |= FLAG_PERMANENT_DEFERRAL;
+    reading.flags |= screeningFlags(reading);
+
+    int component = WHOLE_BLOOD;
+    if (!body["component"].empty()) {
+        component = componentFromName(body["component"]);
+        if (component < 0) return jsonError(res, 422, "Invalid component.");
+    }
+    int type = -1;
+    if (reading.flags & FLAG_DONATED) {
+        // A donor registered without an Rh sign needs the unit's type in the request
+        type = unitBloodType(donor, body["bloodType"]);
+        if (type < 0 && body["bloodType"].empty()) {
+            return jsonError(res, 422, "Donor's full blood type unknown; give bloodType (e.g. A+) for the unit.");
+        }
+        if (type < 0) return jsonError(res, 422, "Invalid bloodType for this donor.");
+    }
+
+    recordHealth(donor, reading);
+    if (reading.flags & ~(FLAG_DONATED | FLAG_LOW_HEMOGLOBIN | FLAG_HIGH_BLOOD_PRESSURE)) {
+        notifyDonor(donor, "Health status update (" + date + "): " + describeFlags(reading.flags) + ".");
+    }
+    JsonObject out;
+    out.addRaw("reading", healthReadingToJson(reading));
+    if (reading.flags & FLAG_DONATED) {
+        out.add("unitId", receiveUnit(donor, type, static_cast<Component>(component), reading.day));
+    }
+    res.status = 201;
+    res.body = out.str();
+}
+
+void handleStock(HttpResponse& res) {
+    inventory.expire(daysFromDate(getCurrentDate()));
+    string out = "[";
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) {
+        if (out.size() > 1) out += ',';
+        out += JsonObject()
+            .add("bloodType", Inventory::typeName(t))
+            .add("wholeBlood", inventory.stock(t, WHOLE_BLOOD))
+            .add("redCells", inventory.stock(t, RED_CELLS))
+            .add("platelets", inventory.stock(t, PLATELETS))
+            .add("plasma", inventory.stock(t, PLASMA))
+            .add("total", inventory.stockOfType(t))
+            .str();
+    }
+    out += ']';
+    res.body = out;
+}
+
+// POST /supervisor/issue {"bloodType","component","count"}
+void handleIssue(const HttpRequest& req, HttpResponse& res) {
+    map<string, string> body;
+    if (!parseJsonObject(req.body, body)) return jsonError(res, 400, "Request body must be a JSON object.");
+    int type = Inventory::typeIndex(body["bloodType"]);
+    if (type < 0) return jsonError(res, 422, "Invalid blood type.");
+    int component = componentFromName(body["component"].empty() ? "whole-blood" : body["component"]);
+    if (component < 0) return jsonError(res, 422, "Invalid component.");
+    int count = atoi(body["count"].c_str());
+    if (count <= 0) return jsonError(res, 422, "Invalid number of units.");
+
+    string units = "[";
+    for (const auto& u : issueUnits(type, static_cast<Component>(component), count)) {
+        if (units.size() > 1) units += ',';
+        units += JsonObject().add("unitId", u.unitId).add("expires", dateFromDays(u.expiryDay)).str();
+    }
+    units += ']';
+    res.body = JsonObject().add("requested", count).addRaw("units", units).str();
+}
+
+// GET /supervisor/cohort?days=90&hbBelow=12.5
+void handleCohort(const HttpRequest& req, HttpResponse& res) {
+    CohortQuery q;
+    q.toDay = daysFromDate(getCurrentDate());
+    string days = req.param("days");
+    int lookBack = days.empty() ? 90 : atoi(days.c_str());
+    if (lookBack < 1 || lookBack > 3650) return jsonError(res, 422, "days must be 1-3650.");
+    q.fromDay = q.toDay - lookBack;
+    string hb = req.param("hbBelow");
+    if (!parseHemoglobin(hb.empty() ? "-" : hb, q.hemoglobinBelow)) return jsonError(res, 422, "Invalid hbBelow value.");
+
+    string out = "[";
+    for (int id : healthStore.cohort(q)) {
+        if (out.size() > 1) out += ',';
+        out += donorToJson(donorsById[id]);
+    }
+    out += ']';
+    res.body = out;
+}
+
+// GET /supervisor/search?q=abebe+bahir+dar&limit=10
+void handleSearchDonors(const HttpRequest& req, HttpResponse& res) {
+    string text = req.param("q");
+    if (text.empty()) return jsonError(res, 422, "Missing q.");
+    string limit = req.param("limit");
+    int count = limit.empty() ? 10 : atoi(limit.c_str());
+    if (count < 1 || count > 100) return jsonError(res, 422, "limit must be 1-100.");
+
+    string out = "[";
+    for (const DonorSearchIndex::Match& m : donorSearch.search(text, count)) {
+        if (out.size() > 1) out += ',';
+        out += JsonObject()
+            .addRaw("donor", donorToJson(donorsById[m.id]))
+            .add("score", static_cast<double>(m.score))
+            .str();
+    }
+    out += ']';
+    res.body = out;
+}
+
+// Area named by the region/city/worda/kebele parameters, or -1
+int locationParam(const HttpRequest& req) {
+    return locations.find(req.param("region"), req.param("city"), req.param("worda"), req.param("kebele"));
+}
+
+// GET /supervisor/area?region=Amhara&city=BahirDar
+// Donors per blood type in the area and each of its sub-areas
+void handleArea(const HttpRequest& req, HttpResponse& res) {
+    int node = locationParam(req);
+    if (node < 0) return jsonError(res, 404, "No donors registered in that area.");
+    auto areaJson = [](int n) {
+        JsonObject byType;
+        for (int t = 0; t < BLOOD_TYPE_COUNT; t++) byType.add(Inventory::typeName(t), locations.count(n, t));
+        return JsonObject().add("name", locations.name(n)).add("total", locations.total(n)).addRaw("byType", byType.str());
+    };
+    string children = "[";
+    for (int c : locations.children(node)) {
+        if (children.size() > 1) children += ',';
+        children += areaJson(c).str();
+    }
+    children += ']';
+    res.body = areaJson(node).addRaw("areas", children).str();
+}
+
+// GET /supervisor/nearby?region=&city=&worda=&kebele=&bloodType=O-&count=20
+// Nearest donors first; "widened" is how many levels up each was found
+void handleNearby(const HttpRequest& req, HttpResponse& res) {
+    int node = locationParam(req);
+    if (node < 0) return jsonError(res, 404, "No donors registered in that area.");
+    unsigned typeMask = LocationIndex::allTypes;
+    string bloodType = req.param("bloodType");
+    if (!bloodType.empty()) {
+        int type = Inventory::typeIndex(bloodType);
+        if (type < 0) return jsonError(res, 422, "Invalid blood type.");
+        typeMask = 1u << type;
+    }
+    string count = req.param("count");
+    int wanted = count.empty() ? 20 : atoi(count.c_str());
+    if (wanted < 1 || wanted > 1000) return jsonError(res, 422, "count must be 1-1000.");
+
+    string out = "[";
+    for (const LocationIndex::Nearby& n : locations.nearest(node, wanted, typeMask)) {
+        if (out.size() > 1) out += ',';
+        out += JsonObject().addRaw("donor", donorToJson(donorsById[n.donorId])).add("widened", n.widened).str();
+    }
+    out += ']';
+    res.body = out;
+}
+
+// GET /supervisor/stats?gender=&bloodType=&region=&city=&from=2024-01&to=2024-12
+// Matching donor count, split by blood type
+void handleStats(const HttpRequest& req, HttpResponse& res) {
+    static const char* names[ATTR_COUNT] = {"gender", "bloodType", "region", "city"};
+    DonorFilter filter;
+    for (int a = 0; a < ATTR_COUNT; a++) filter.values[a] = req.param(names[a]);
+    filter.fromMonth = req.param("from");
+    filter.toMonth = req.param("to");
+
+    JsonObject byBloodType;
+    for (const auto& entry : donorAttributes.countBy(filter, ATTR_BLOOD_TYPE)) {
+        byBloodType.add(entry.first, static_cast<long long>(entry.second));
+    }
+    res.body = JsonObject()
+        .add("count", static_cast<long long>(donorAttributes.count(filter)))
+        .addRaw("byBloodType", byBloodType.str())
+        .str();
+}
+
+// GET /supervisor/dashboard?check=1
+// Live overview; check=1 also recounts it and lists any differences
+void handleDashboard(const HttpRequest& req, HttpResponse& res) {
+    vector<string> differences;
+    bool check = req.param("check") == "1";
+    DashboardSnapshot s = readDashboard(check ? &differences : nullptr);
+    JsonObject donorsByType, eligibleByType, stock;
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) {
+        donorsByType.add(Inventory::typeName(t), s.donorsByType[t]);
+        eligibleByType.add(Inventory::typeName(t), s.eligibleByType[t]);
+        stock.add(Inventory::typeName(t), s.stockByType[t]);
+    }
+    JsonObject out;
+    out.add("date", dateFromDays(s.day))
+        .add("donors", s.donors)
+        .addRaw("donorsByType", donorsByType.str())
+        .add("eligible", s.eligible)
+        .addRaw("eligibleByType", eligibleByType.str())
+        .add("appointmentsToday", s.appointmentsToday)
+        .add("appointmentsThisWeek", s.appointmentsThisWeek)
+        .addRaw("stockByType", stock.str());
+    if (check) {
+        string list = "[";
+        for (const string& line : differences) {
+            if (list.size() > 1) list += ',';
+            list += '"';
+            jsonEscapeTo(list, line);
+            list += '"';
+        }
+        list += ']';
+        out.add("consistent", differences.empty()).addRaw("differences", list);
+    }
+    res.body = out.str();
+}
+
+// GET /supervisor/eligible-soon?days=7
+void handleEligibleSoon(const HttpRequest& req, HttpResponse& res) {
+    int today = daysFromDate(getCurrentDate());
+    string days = req.param("days");
+    int window = days.empty() ? 7 : atoi(days.c_str());
+    if (window < 1 || window > 365) return jsonError(res, 422, "days must be 1-365.");
+
+    string out = "[";
+    for (int id : eligibility.becomingEligible(today, today + window - 1)) {
+        if (out.size() > 1) out += ',';
+        out += JsonObject()
+            .add("username", donorsById[id]->username)
+            .add("bloodType", donorsById[id]->bloodType)
+            .add("eligibleFrom", dateFromDays(eligibility.nextEligibleDay(id)))
+            .str();
+    }
+    out += ']';
+    res.body = out;
+}
+
+// Reads a snapshot, so it runs without storeMutex and doesn't hold up registrations
+void handleListDonors(HttpResponse& res) {
+    auto snap = donorVersions.snapshot();
+    string out = "[";
+    for (size_t id = snap.size(); id-- > 0;) {
+        const Donor* const* d = snap.get(id);
+        if (!d) continue;
+        if (out.size() > 1) out += ',';
+        out += donorToJson(*d);
+    }
+    out += ']';
+    res.body = out;
+}
+
+// Routes one request. Authenticated endpoints take the token returned by
+// /login or /supervisor/login as "Authorization: Bearer <token>".
+void handleRequest(const HttpRequest& req, HttpResponse& res) {
+    TIME_OPERATION("bloodbank_http_request");
+    if (req.path == "/health") {
+        res.body = "{\"status\":\"ok\"}";
+        return;
+    }
+    if (req.path == "/metrics") {
+        res.contentType = "text/plain; version=0.0.4";
+        res.body = Metrics::prometheus();
+        return;
+    }
+
+    // Session checks don't touch the donor lists, so they run before the store lock
+    string token = bearerToken(req);
+    SessionState session{nullptr, false};
+    bool loggedIn = sessions.lookup(token, session);
+
+    if (req.path == "/logout") {
+        if (req.method != "POST") return jsonError(res, 405, "Use POST.");
+        sessions.revoke(token);
+        res.status = 204;
+        return;
+    }
+    if (req.path == "/supervisor/login") {
+        if (req.method != "POST") return jsonError(res, 405, "Use POST.");
+        return handleSupervisorLogin(req, res);
+    }
+
+    if (req.path == "/supervisor/donors") {
+        if (!loggedIn || !session.supervisor) return jsonError(res, 401, "Supervisor login required.");
+        if (req.method != "GET") return jsonError(res, 405, "Use GET.");
+        return handleListDonors(res);
+    }
+
+    // The core calls lock the store themselves
+    if (req.path == "/register") {
+        if (req.method != "POST") return jsonError(res, 405, "Use POST.");
+        return handleRegister(req, res);
+    }
+    if (req.path == "/login") {
+        if (req.method != "POST") return jsonError(res, 405, "Use POST.");
+        return handleLogin(req, res);
+    }
+    if (req.path == "/appointments" && req.method == "POST") {
+        if (!loggedIn || session.donor == nullptr) return jsonError(res, 401, "Donor login required.");
+        return handleBookAppointment(session.donor, req, res);
+    }
+
+    lock_guard<mutex> lock(storeMutex);
+
+    if (req.path == "/appointments") {
+        if (!loggedIn || session.donor == nullptr) return jsonError(res, 401, "Donor login required.");
+        if (req.method == "GET") return handleListAppointments(session.donor->username, res);
+        return jsonError(res, 405, "Use GET or POST.");
+    }
+
+    if (req.path == "/health-records") {
+        if (!loggedIn || session.donor == nullptr) return jsonError(res, 401, "Donor login required.");
+        if (req.method != "GET") return jsonError(res, 405, "Use GET.");
+        return handleHealthRecords(session.donor, res);
+    }
+
+    if (req.path.compare(0, 12, "/supervisor/") == 0) {
+        if (!loggedIn || !session.supervisor) return jsonError(res, 401, "Supervisor login required.");
+        if (req.path == "/supervisor/health-records") {
+            if (req.method != "POST") return jsonError(res, 405, "Use POST.");
+            return handleRecordHealth(req, res);
+        }
+        if (req.path == "/supervisor/issue") {
+            if (req.method != "POST") return jsonError(res, 405, "Use POST.");
+            return handleIssue(req, res);
+        }
+        if (req.method != "GET") return jsonError(res, 405, "Use GET.");
+        if (req.path == "/supervisor/appointments") return handleListAppointments("", res);
+        if (req.path == "/supervisor/cohort") return handleCohort(req, res);
+        if (req.path == "/supervisor/search") return handleSearchDonors(req, res);
+        if (req.path == "/supervisor/area") return handleArea(req, res);
+        if (req.path == "/supervisor/nearby") return handleNearby(req, res);
+        if (req.path == "/supervisor/stats") return handleStats(req, res);
+        if (req.path == "/supervisor/dashboard") return handleDashboard(req, res);
+        if (req.path == "/supervisor/eligible-soon") return handleEligibleSoon(req, res);
+        if (req.path == "/supervisor/stock") return handleStock(res);
+    }
+
+    jsonError(res, 404, "Unknown endpoint.");
+}
+
+// Sizes reported with the operation metrics (GET /metrics)
+void setupMetrics() {
+#ifndef DISABLE_METRICS
+    Metrics::registerGauge("bloodbank_donors", "Registered donors", []() {
+        return static_cast<double>(donorVersions.size());
+    });
+    Metrics::registerGauge("bloodbank_appointments", "Booked appointments", []() {
+        lock_guard<mutex> lock(storeMutex);
+        return static_cast<double>(appointments.size());
+    });
+    Metrics::registerGauge("bloodbank_sessions", "Active login sessions", []() {
+        return static_cast<double>(sessions.size());
+    });
+    Metrics::registerGauge("bloodbank_stock_units", "Blood units in stock", []() {
+        lock_guard<mutex> lock(storeMutex);
+        int total = 0;
+        for (int t = 0; t < BLOOD_TYPE_COUNT; t++) total += inventory.stockOfType(t);
+        return static_cast<double>(total);
+    });
+    Metrics::registerGauge("bloodbank_notifications_pending", "Notifications not yet delivered", []() {
+        PipelineStats stats = notifications.snapshot();
+        return static_cast<double>(stats.scheduled + stats.retrying + stats.ready);
+    });
+#endif
+}
+
+int runServer(int port, int threads) {
+#ifdef __linux__
+    HttpServer server(port, handleRequest, threads);
+    if (!server.listen()) {
+        cout << "❌ Could not listen on port " << port << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    cout << "🩸 Blood bank server listening on port " << port
+         << " with " << server.threads() << " event loop(s).\n";
+
+    // Messages are dispatched every second; tomorrow's reminders go out once a day
+    notifications.start(1000);
+    atomic<bool> serving(true);
+    thread reminders([&serving]() {
+        while (serving) {
+            {
+                lock_guard<mutex> lock(storeMutex);
+                sendAppointmentReminders(daysFromDate(getCurrentDate()) + 1);
+            }
+            for (int i = 0; i < 60 && serving; i++) this_thread::sleep_for(chrono::seconds(1));
+        }
+    });
+
+    server.loop();
+    serving = false;
+    reminders.join();
+    notifications.stop();
+    return 0;
+#else
+    (void)port;
+    (void)threads;
+    cout << "❌ Server mode is only available on Linux.\n";
+    return 1;
+#endif
+}
+
+// ================= Binary donor records =================
+
+// Version 1 fields, in order. Gender, blood type and places repeat a lot, so
+// they go through the dictionary.
+void writeDonor(BinaryWriter& w, const Donor& d) {
+    w.putUint(static_cast<uint64_t>(d.id));
+    w.putString(d.username);
+    w.putString(d.password);
+    w.putString(d.firstName);
+    w.putString(d.lastName);
+    w.putDictString(d.gender);
+    w.putString(d.phone);
+    w.putDictString(d.bloodType);
+    w.putString(d.email);
+    w.putDictString(d.city);
+    w.putDictString(d.region);
+    w.putDictString(d.kebele);
+    w.putDictString(d.worda);
+    w.putDate(d.registeredOn);
+    w.endRecord();
+}
+
+bool readDonor(RecordCursor& c, DonorFields& d) {
+    if (c.recordType() != DONOR_RECORD_TYPE) return false;
+    d.id = static_cast<int>(c.getUint());
+    d.username = c.getString();
+    d.password = c.getString();
+    d.firstName = c.getString();
+    d.lastName = c.getString();
+    d.gender = c.getDictString();
+    d.phone = c.getString();
+    d.bloodType = c.getDictString();
+    d.email = c.getString();
+    d.city = c.getDictString();
+    d.region = c.getDictString();
+    d.kebele = c.getDictString();
+    d.worda = c.getDictString();
+    d.registeredOn = c.getDate();
+    return c.ok();
+}
+
+// ================= Load generation =================
+// Seeded streams of registrations, logins, bookings and supervisor views.
+// Donor operations call the core API; supervisor views go through
+// handleRequest like the server's requests (minus the sockets).
+
+const vector<LoadKind> loadKinds = {
+    {"register", 15, true}, {"login", 40, false}, {"book", 25, false}, {"supervisor", 20, false}};
+
+// Letters-only name part for a number (validation rejects digits in names)
+string lettersFor(uint32_t n) {
+    string out;
+    do {
+        out += static_cast<char>('a' + n % 26);
+        n /= 26;
+    } while (n > 0);
+    return out;
+}
+
+// Runs one GET in-process; returns the status code
+int loadGet(const string& path, const string& query, const string& token) {
+    HttpRequest req;
+    req.method = "GET";
+    req.path = path;
+    req.query = query;
+    req.headers.push_back({"authorization", "Bearer " + token});
+    HttpResponse res;
+    handleRequest(req, res);
+    return res.status;
+}
+
+// bloodbank --loadgen [operations] [rate/s, 0 = max] [threads] [seed] [trace file to write]
+// bloodbank --replay <trace file> [rate/s] [threads]
+int runLoad(int argc, char* argv[], int arg) {
+    bool replay = string(argv[arg]) == "--replay";
+    Workload w;
+    LoadConfig config;
+    if (replay) {
+        if (argc <= arg + 1 || !Workload::load(argv[arg + 1], loadKinds, w)) {
+            cout << "❌ Could not read trace " << (argc > arg + 1 ? argv[arg + 1] : "") << "\n";
+            return 1;
+        }
+        config.rate = argc > arg + 2 ? atof(argv[arg + 2]) : 0;
+        config.threads = argc > arg + 3 ? atoi(argv[arg + 3]) : 1;
+    } else {
+        long operations = argc > arg + 1 ? atol(argv[arg + 1]) : 100000;
+        config.rate = argc > arg + 2 ? atof(argv[arg + 2]) : 0;
+        config.threads = argc > arg + 3 ? atoi(argv[arg + 3]) : 1;
+        uint64_t seed = argc > arg + 4 ? strtoull(argv[arg + 4], nullptr, 10) : 1;
+        if (operations <= 0) {
+            cout << "❌ Usage: bloodbank --loadgen [operations] [rate] [threads] [seed] [trace file]\n";
+            return 1;
+        }
+        w = Workload::generate(loadKinds, static_cast<size_t>(operations), seed);
+        if (argc > arg + 5 && !w.save(argv[arg + 5])) {
+            cout << "❌ Could not write trace " << argv[arg + 5] << "\n";
+            return 1;
+        }
+    }
+    if (config.threads < 1 || config.rate < 0) {
+        cout << "❌ Threads must be at least 1 and the rate not negative.\n";
+        return 1;
+    }
+
+    static const char* bloodTypes[] = {"A+", "A-", "B+", "B-", "AB+", "AB-", "O+", "O-"};
+    static const char* regions[] = {"Amhara", "Oromia", "Tigray", "Sidama"};
+    static const char* cities[] = {"BahirDar", "Gondar", "Adama", "Jimma", "Mekelle", "Hawassa"};
+    int today = daysFromDate(getCurrentDate());
+    string supervisorToken = supervisorLogin("sup1", "sup123456").token;
+    vector<const Donor*> loggedIn(w.actors); // an actor only ever runs on one thread
+
+    LoadReport report = runWorkload(w, config, [&](const LoadEvent& e, int) {
+        const string& kind = loadKinds[e.kind].name;
+        string username = "load" + to_string(e.actor), password = "secret" + to_string(e.actor);
+        if (kind == "register") {
+            string phone = to_string(e.actor % 100000000);
+            DonorInput input;
+            input.firstName = "Donor" + lettersFor(e.actor);
+            input.lastName = "Load";
+            input.gender = e.arg & 1 ? "female" : "male";
+            input.phone = "09" + string(8 - phone.size(), '0') + phone;
+            input.username = username;
+            input.password = password;
+            input.bloodType = bloodTypes[(e.arg >> 1) % 8];
+            input.city = cities[(e.arg >> 4) % 6];
+            input.region = regions[(e.arg >> 8) % 4];
+            input.kebele = "Kebele" + lettersFor((e.arg >> 12) % 20);
+            input.worda = "Worda" + lettersFor((e.arg >> 20) % 8);
+            return registerDonor(std::move(input)).ok();
+        }
+        if (kind == "login" || (kind == "book" && !loggedIn[e.actor])) {
+            loggedIn[e.actor] = login(username, password).donor;
+            if (kind == "login" || !loggedIn[e.actor]) return loggedIn[e.actor] != nullptr;
+        }
+        if (kind == "book") {
+            int minutes = 8 * 60 + static_cast<int>((e.arg >> 8) % 16) * 30;
+            char time[6];
+            snprintf(time, sizeof(time), "%02d:%02d", minutes / 60, minutes % 60);
+            string date = dateFromDays(today + 1 + static_cast<int>(e.arg % 60));
+            return book(loggedIn[e.actor], date, time, "load test").ok();
+        }
+        switch (e.arg % 3) {
+        case 0:
+            return loadGet("/supervisor/dashboard", "", supervisorToken) == 200;
+        case 1:
+            return loadGet("/supervisor/stats", string("bloodType=") + bloodTypes[(e.arg >> 2) % 8],
+                           supervisorToken) == 200;
+        default:
+            return loadGet("/supervisor/search", "q=" + string(cities[(e.arg >> 2) % 6]) + "&limit=10",
+                           supervisorToken) == 200;
+        }
+    });
+
+    cout << (replay ? "🔁 Replayed " : "📈 Generated ") << w.events.size() << " events, " << w.actors
+         << " donors, " << config.threads << " thread(s), "
+         << (config.rate > 0 ? to_string(static_cast<long long>(config.rate)) + " ops/s target" : "unthrottled")
+         << "\n";
+    printLoadReport(report, cout);
+    if (report.total.failures > 0) cout << "⚠️ " << report.total.failures << " operation(s) failed.\n";
+    return report.total.failures > 0 ? 1 : 0;
+}
+
+// Encodes, scans and decodes `count` generated donors, best of 5 runs each.
+// bloodbank --binary-bench [donors]
+int runBinaryBench(int count) {
+    static const char* bloodTypes[] = {"A+", "A-", "B+", "B-", "AB+", "AB-", "O+", "O-"};
+    static const char* regions[] = {"Amhara", "Oromia", "Tigray", "Sidama"};
+    static const char* cities[] = {"BahirDar", "Gondar", "Adama", "Jimma", "Mekelle", "Hawassa"};
+    mt19937 rng(42);
+    vector<Donor> generated(count);
+    for (int i = 0; i < count; i++) {
+        Donor& d = generated[i];
+        d.id = i;
+        d.username = "donor" + to_string(i);
+        d.password = "secret" + to_string(rng() % 1000000);
+        d.firstName = "Abebe" + lettersFor(rng() % 500);
+        d.lastName = "Kebede" + lettersFor(rng() % 500);
+        d.gender = rng() % 2 ? "female" : "male";
+        d.phone = "09" + to_string(10000000 + rng() % 90000000);
+        d.bloodType = bloodTypes[rng() % 8];
+        d.email = rng() % 3 ? d.username + "@example.com" : "";
+        d.city = cities[rng() % 6];
+        d.region = regions[rng() % 4];
+        d.kebele = "Kebele" + lettersFor(rng() % 20);
+        d.worda = "Worda" + lettersFor(rng() % 8);
+        d.registeredOn = dateFromDays(daysFromDate("2023-01-01") + static_cast<int>(rng() % 1000));
+        d.next = nullptr;
+    }
+
+    auto best = [](auto run) {
+        double fastest = 1e30;
+        for (int r = 0; r < 5; r++) {
+            auto start = chrono::steady_clock::now();
+            run();
+            fastest = min(fastest, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        return fastest;
+    };
+
+    string buffer;
+    double encode = best([&]() {
+        BinaryWriter w(DONOR_RECORD_TYPE);
+        w.reserve(buffer.size() + 64); // the previous run's size
+        for (const Donor& d : generated) writeDonor(w, d);
+        buffer = w.take();
+    });
+
+    // Zero-copy: fields are read in place, nothing is allocated
+    int oNegative = 0;
+    double scan = best([&]() {
+        oNegative = 0;
+        BinaryReader reader(buffer);
+        RecordCursor c;
+        DonorFields f;
+        while (reader.next(c) && readDonor(c, f)) oNegative += f.bloodType == "O-" && f.city == "Adama";
+    });
+
+    vector<Donor> decoded;
+    double decode = best([&]() {
+        decoded.assign(count, Donor());
+        BinaryReader reader(buffer);
+        RecordCursor c;
+        DonorFields f;
+        for (int i = 0; i < count && reader.next(c) && readDonor(c, f); i++) {
+            Donor& d = decoded[i];
+            d.id = f.id;
+            d.username = f.username;
+            d.password = f.password;
+            d.firstName = f.firstName;
+            d.lastName = f.lastName;
+            d.gender = f.gender;
+            d.phone = f.phone;
+            d.bloodType = f.bloodType;
+            d.email = f.email;
+            d.city = f.city;
+            d.region = f.region;
+            d.kebele = f.kebele;
+            d.worda = f.worda;
+            d.registeredOn = unpackDate(f.registeredOn);
+        }
+    });
+
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        const Donor& a = generated[i];
+        const Donor& b = decoded[i];
+        mismatches += a.id != b.id || a.username != b.username || a.password != b.password ||
+                      a.firstName != b.firstName || a.lastName != b.lastName || a.gender != b.gender ||
+                      a.phone != b.phone || a.bloodType != b.bloodType || a.email != b.email ||
+                      a.city != b.city || a.region != b.region || a.kebele != b.kebele || a.worda != b.worda ||
+                      a.registeredOn != b.registeredOn;
+    }
+
+    double mb = static_cast<double>(buffer.size()) / 1e6;
+    auto report = [&](const char* what, double seconds) {
+        cout << what << seconds * 1e9 / count << " ns/donor, " << static_cast<long long>(count / seconds)
+             << " donors/s, " << static_cast<long long>(mb / seconds) << " MB/s\n";
+    };
+    cout << "📦 " << count << " donors in " << buffer.size() << " bytes ("
+         << static_cast<double>(buffer.size()) / count << " bytes/donor)\n";
+    report("Encode:           ", encode);
+    report("Zero-copy scan:   ", scan);
+    report("Decode to objects:", decode);
+    cout << "Scan check: " << oNegative << " O- donors in Adama\n";
+    if (mismatches > 0) {
+        cout << "❌ Round trip mismatches: " << mismatches << "\n";
+        return 1;
+    }
+    cout << "✅ Round trip exact.\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    setupNotifications();
+    setupMetrics();
+
+    // bloodbank [--check-dashboard] [--serve [port] [event loops]]
+    // bloodbank [--check-dashboard] --loadgen|--replay ... (see runLoad)
+    // bloodbank --binary-bench [donors]
+    int arg = 1;
+    if (argc > arg && string(argv[arg]) == "--check-dashboard") {
+        checkDashboard = true;
+        arg++;
+    }
+    if (argc > arg && (string(argv[arg]) == "--loadgen" || string(argv[arg]) == "--replay")) {
+        return runLoad(argc, argv, arg);
+    }
+    if (argc > arg && string(argv[arg]) == "--binary-bench") {
+        int count = argc > arg + 1 ? atoi(argv[arg + 1]) : 1000000;
+        return runBinaryBench(count > 0 ? count : 1000000);
+    }
+    if (argc > arg && string(argv[arg]) == "--serve") {
+        int port = argc > arg + 1 ? atoi(argv[arg + 1]) : 8080;
+        int threads = argc > arg + 2 ? atoi(argv[arg + 2]) : 0;
+        return runServer(port, threads);
+    }
 
-int main() {
     mainMenu();
     return 0;
 }
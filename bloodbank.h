@@ -0,0 +1,99 @@
+// bloodbank.h
+#ifndef BLOODBANK_H
+#define BLOODBANK_H
+
+// Core blood bank operations, free of console and HTTP code: they never
+// read input or print, and report how they went as a status code plus a
+// message the front end can show. The console menus and the HTTP handlers in
+// bloodbank.cpp are thin layers over these. Every call locks the shared
+// store itself, so they can be called from any thread.
+
+#include <string>
+#include <string_view>
+#include "binary_records.h"
+
+// What a donor gives when registering
+struct DonorInput {
+    std::string firstName;
+    std::string lastName;
+    std::string gender;
+    std::string phone;
+    std::string username;
+    std::string password;
+    std::string bloodType;
+    std::string email;
+    std::string city;
+    std::string region;
+    std::string kebele;
+    std::string worda;
+};
+
+struct Donor : DonorInput {
+    std::string registeredOn; // YYYY-MM-DD, set by addDonor
+    int id;       // position in donorsById, used by the health store
+    Donor* next;
+};
+
+enum BankStatus {
+    BANK_OK,
+    BANK_INVALID_INPUT,   // a field failed validation
+    BANK_USERNAME_TAKEN,
+    BANK_BAD_CREDENTIALS,
+    BANK_NOT_ELIGIBLE,    // deferred on the requested day
+};
+
+struct BankResult {
+    BankStatus status;
+    std::string message; // why it failed, or a confirmation
+
+    bool ok() const {
+        return status == BANK_OK;
+    }
+};
+
+struct LoginResult {
+    BankStatus status;
+    const Donor* donor; // nullptr for the supervisor or on failure
+    std::string token;  // session token for later calls
+};
+
+// Validates and adds a donor; `created`, if given, receives it
+BankResult registerDonor(DonorInput&& input, const Donor** created = nullptr);
+
+// Starts a donor session
+LoginResult login(const std::string& username, const std::string& password);
+
+// Starts a supervisor session
+LoginResult supervisorLogin(const std::string& username, const std::string& password);
+
+// Books an appointment for a logged-in donor
+BankResult book(const Donor* donor, const std::string& date, const std::string& time, const std::string& message);
+
+// ---- Binary donor records (binary_records.h) ----
+
+const uint8_t DONOR_RECORD_TYPE = 2;
+
+// A donor read in place from a binary buffer; the strings point into it
+struct DonorFields {
+    int id;
+    std::string_view username;
+    std::string_view password;
+    std::string_view firstName;
+    std::string_view lastName;
+    std::string_view gender;
+    std::string_view phone;
+    std::string_view bloodType;
+    std::string_view email;
+    std::string_view city;
+    std::string_view region;
+    std::string_view kebele;
+    std::string_view worda;
+    uint64_t registeredOn; // packed, unpackDate() gives YYYY-MM-DD
+};
+
+void writeDonor(BinaryWriter& w, const Donor& d);
+
+// False if the record is not a donor or is cut short
+bool readDonor(RecordCursor& c, DonorFields& d);
+
+#endif
@@ -1,6 +1,6 @@
 @echo off
-g++ main.cpp -o main ^
+g++ -std=c++20 main.cpp -o main ^
  -IC:\msys64\ucrt64\include ^
  -LC:\msys64\ucrt64\lib ^
- -lpq
+ -lpq -lws2_32
 pause
@@ -0,0 +1,357 @@
+// containers.h
+#ifndef CONTAINERS_H
+#define CONTAINERS_H
+
+// Containers shared by the task manager and the blood bank:
+//   IntrusiveList  singly linked list threaded through a T::next member,
+//                  with O(1) push at either end and no allocation of its own
+//   DaryHeap       heap with a compile-time arity; an index policy is told
+//                  every element's position so it can be updated or erased
+//                  in O(log n) from outside
+//   FlatHashMap    open-addressing hash map in one array (linear probing,
+//                  backward-shift erase, no tombstones)
+// DaryHeap and FlatHashMap take comparator/hash and allocator policies.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// ---- IntrusiveList ----
+
+template <typename T, T* T::*Next = &T::next>
+class IntrusiveList {
+private:
+    T* first = nullptr;
+    T* last = nullptr;
+    size_t count = 0;
+
+public:
+    class iterator {
+    private:
+        T* node;
+
+    public:
+        explicit iterator(T* node) : node(node) {}
+        T* operator*() const { return node; }
+        iterator& operator++() {
+            node = node->*Next;
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return node != other.node; }
+        bool operator==(const iterator& other) const { return node == other.node; }
+    };
+
+    void pushFront(T* node) {
+        node->*Next = first;
+        first = node;
+        if (!last) last = node;
+        count++;
+    }
+
+    void pushBack(T* node) {
+        node->*Next = nullptr;
+        if (last) last->*Next = node;
+        else first = node;
+        last = node;
+        count++;
+    }
+
+    // Unlinks every node without freeing it (e.g. before relinking in a new order)
+    void clear() {
+        first = last = nullptr;
+        count = 0;
+    }
+
+    // Frees every node with deleter and empties the list
+    template <typename Deleter = std::default_delete<T>>
+    void deleteAll(Deleter deleter = Deleter()) {
+        T* node = first;
+        while (node) {
+            T* next = node->*Next;
+            deleter(node);
+            node = next;
+        }
+        clear();
+    }
+
+    T* front() const { return first; }
+    T* back() const { return last; }
+    bool empty() const { return first == nullptr; }
+    size_t size() const { return count; }
+
+    iterator begin() const { return iterator(first); }
+    iterator end() const { return iterator(nullptr); }
+};
+
+// ---- DaryHeap ----
+
+// Index policy for heaps whose elements are never updated or erased in place
+struct NoHeapIndex {
+    template <typename T>
+    void operator()(const T&, size_t) const {}
+};
+
+// Before(a, b) is true when a must come out before b; top() is the element
+// nothing comes before. Index(item, pos) is called whenever an item moves,
+// and with npos when it leaves the heap.
+template <typename T, typename Before = std::less<T>, size_t Arity = 4,
+          typename Index = NoHeapIndex, typename Allocator = std::allocator<T>>
+class DaryHeap {
+    static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+private:
+    std::vector<T, Allocator> items;
+    Before before;
+    Index index;
+
+    void place(size_t i, T item) {
+        items[i] = std::move(item);
+        index(items[i], i);
+    }
+
+    void siftUp(size_t i) {
+        T item = std::move(items[i]);
+        while (i > 0) {
+            size_t parent = (i - 1) / Arity;
+            if (!before(item, items[parent])) break;
+            place(i, std::move(items[parent]));
+            i = parent;
+        }
+        place(i, std::move(item));
+    }
+
+    void siftDown(size_t i) {
+        T item = std::move(items[i]);
+        size_t n = items.size();
+        while (true) {
+            size_t child = firstChild(i);
+            if (child >= n) break;
+            size_t best = child;
+            size_t end = child + Arity < n ? child + Arity : n;
+            for (size_t c = child + 1; c < end; c++) {
+                if (before(items[c], items[best])) best = c;
+            }
+            if (!before(items[best], item)) break;
+            place(i, std::move(items[best]));
+            i = best;
+        }
+        place(i, std::move(item));
+    }
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+    static constexpr size_t arity = Arity;
+
+    explicit DaryHeap(Before before = Before(), Index index = Index(), const Allocator& alloc = Allocator())
+        : items(alloc), before(std::move(before)), index(std::move(index)) {}
+
+    static size_t firstChild(size_t i) {
+        return i * Arity + 1;
+    }
+
+    void push(T item) {
+        items.push_back(std::move(item));
+        siftUp(items.size() - 1);
+    }
+
+    // Appends without ordering; call heapify() before the next top/pop
+    void pushUnordered(T item) {
+        items.push_back(std::move(item));
+        index(items.back(), items.size() - 1);
+    }
+
+    // Orders the whole array in O(n)
+    void heapify() {
+        for (size_t i = 0; i < items.size(); i++) index(items[i], i);
+        if (items.size() < 2) return;
+        for (size_t i = (items.size() - 2) / Arity + 1; i-- > 0;) siftDown(i);
+    }
+
+    const T& top() const {
+        return items[0];
+    }
+
+    T pop() {
+        return erase(0);
+    }
+
+    // Removes the item at pos (as reported to the index policy)
+    T erase(size_t pos) {
+        T item = std::move(items[pos]);
+        index(item, npos);
+        T last = std::move(items.back());
+        items.pop_back();
+        if (pos < items.size()) {
+            place(pos, std::move(last));
+            update(pos);
+        }
+        return item;
+    }
+
+    // Restores order after the key of the item at pos changed
+    void update(size_t pos) {
+        if (pos > 0 && before(items[pos], items[(pos - 1) / Arity])) siftUp(pos);
+        else siftDown(pos);
+    }
+
+    void reserve(size_t n) {
+        items.reserve(n);
+    }
+
+    void clear() {
+        for (T& item : items) index(item, npos);
+        items.clear();
+    }
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    const T& operator[](size_t i) const { return items[i]; }
+    typename std::vector<T, Allocator>::const_iterator begin() const { return items.begin(); }
+    typename std::vector<T, Allocator>::const_iterator end() const { return items.end(); }
+
+    const Before& comparator() const { return before; }
+};
+
+// ---- FlatHashMap ----
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>,
+          typename Allocator = std::allocator<std::pair<K, V>>>
+class FlatHashMap {
+private:
+    struct Slot {
+        K key;
+        V value;
+        bool used = false;
+    };
+
+    using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+    std::vector<Slot, SlotAllocator> slots;
+    size_t count = 0;
+    size_t mask = 0;
+    Hash hasher;
+    Equal equal;
+
+    // Spreads weak hashes (std::hash<int> is the identity) over the table
+    size_t home(const K& key) const {
+        uint64_t h = static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32)) & mask;
+    }
+
+    // Slot holding key, or the empty slot where it would go
+    size_t probe(const K& key) const {
+        size_t i = home(key);
+        while (slots[i].used && !equal(slots[i].key, key)) i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow() {
+        std::vector<Slot, SlotAllocator> old(slots.empty() ? 16 : slots.size() * 2, slots.get_allocator());
+        old.swap(slots);
+        mask = slots.size() - 1;
+        for (Slot& s : old) {
+            if (!s.used) continue;
+            Slot& dst = slots[probe(s.key)];
+            dst.key = std::move(s.key);
+            dst.value = std::move(s.value);
+            dst.used = true;
+        }
+    }
+
+public:
+    explicit FlatHashMap(Hash hasher = Hash(), Equal equal = Equal(), const Allocator& alloc = Allocator())
+        : slots(SlotAllocator(alloc)), hasher(std::move(hasher)), equal(std::move(equal)) {}
+
+    // Pointer to the value for key, or nullptr
+    V* find(const K& key) {
+        if (count == 0) return nullptr;
+        Slot& s = slots[probe(key)];
+        return s.used ? &s.value : nullptr;
+    }
+
+    const V* find(const K& key) const {
+        if (count == 0) return nullptr;
+        const Slot& s = slots[probe(key)];
+        return s.used ? &s.value : nullptr;
+    }
+
+    bool contains(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    // Adds key if missing (kept below 3/4 full) and returns its value
+    V& operator[](const K& key) {
+        if ((count + 1) * 4 > slots.size() * 3) grow();
+        Slot& s = slots[probe(key)];
+        if (!s.used) {
+            s.key = key;
+            s.value = V();
+            s.used = true;
+            count++;
+        }
+        return s.value;
+    }
+
+    // Adds key -> value unless key is present. Returns whether it was added.
+    bool insert(const K& key, V value) {
+        if ((count + 1) * 4 > slots.size() * 3) grow();
+        Slot& s = slots[probe(key)];
+        if (s.used) return false;
+        s.key = key;
+        s.value = std::move(value);
+        s.used = true;
+        count++;
+        return true;
+    }
+
+    bool erase(const K& key) {
+        if (count == 0) return false;
+        size_t i = probe(key);
+        if (!slots[i].used) return false;
+        // Backward shift: pull later entries of the probe run into the hole
+        size_t hole = i;
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            if (!slots[j].used) break;
+            size_t h = home(slots[j].key);
+            // Move j only if its home is not between the hole and j (cyclically)
+            bool between = hole <= j ? (hole < h && h <= j) : (hole < h || h <= j);
+            if (!between) {
+                slots[hole].key = std::move(slots[j].key);
+                slots[hole].value = std::move(slots[j].value);
+                hole = j;
+            }
+        }
+        slots[hole].used = false;
+        slots[hole].key = K();
+        slots[hole].value = V();
+        count--;
+        return true;
+    }
+
+    void reserve(size_t n) {
+        while (n * 4 > slots.size() * 3) grow();
+    }
+
+    void clear() {
+        for (Slot& s : slots) s = Slot();
+        count = 0;
+    }
+
+    // Calls fn(key, value) for every entry, in table order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (const Slot& s : slots) {
+            if (s.used) fn(s.key, s.value);
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+#endif
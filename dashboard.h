@@ -0,0 +1,147 @@
+// dashboard.h
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+// Supervisor overview kept up to date as things happen instead of recounted
+// from the donor and appointment lists on every open.
+// Registrations, bookings, eligibility changes and stock movements each
+// adjust a few counters. Deferrals and units run out on a known day, so those
+// days are kept in a schedule and advance(today) rolls off whatever has passed
+// since the last read; reads are O(1) apart from that amortized roll-off.
+
+#include <climits>
+#include <map>
+#include <string>
+#include <vector>
+#include "containers.h"
+#include "inventory.h"
+
+const int DASHBOARD_TYPES = BLOOD_TYPE_COUNT + 1; // last slot = type not fully known
+
+struct DashboardSnapshot {
+    int day = 0;
+    int donors = 0;
+    int donorsByType[DASHBOARD_TYPES] = {};
+    int eligible = 0;
+    int eligibleByType[DASHBOARD_TYPES] = {};
+    int appointmentsToday = 0;
+    int appointmentsThisWeek = 0; // today and the next 6 days
+    int stockByType[BLOOD_TYPE_COUNT] = {};
+};
+
+// Lines describing where two snapshots disagree (empty if they match)
+inline std::vector<std::string> dashboardDifferences(const DashboardSnapshot& a, const DashboardSnapshot& b) {
+    std::vector<std::string> out;
+    auto check = [&out](const std::string& what, int x, int y) {
+        if (x != y) out.push_back(what + ": " + std::to_string(x) + " vs " + std::to_string(y));
+    };
+    auto typeName = [](int t) {
+        return std::string(t < BLOOD_TYPE_COUNT ? Inventory::typeName(t) : "unknown");
+    };
+    check("donors", a.donors, b.donors);
+    check("eligible", a.eligible, b.eligible);
+    for (int t = 0; t < DASHBOARD_TYPES; t++) {
+        check("donors " + typeName(t), a.donorsByType[t], b.donorsByType[t]);
+        check("eligible " + typeName(t), a.eligibleByType[t], b.eligibleByType[t]);
+    }
+    check("appointments today", a.appointmentsToday, b.appointmentsToday);
+    check("appointments this week", a.appointmentsThisWeek, b.appointmentsThisWeek);
+    for (int t = 0; t < BLOOD_TYPE_COUNT; t++) check("stock " + typeName(t), a.stockByType[t], b.stockByType[t]);
+    return out;
+}
+
+class Dashboard {
+private:
+    DashboardSnapshot state;
+    int deferredByType[DASHBOARD_TYPES] = {};
+    int today = INT_MIN;
+    FlatHashMap<int, int> appointmentsOn;     // day -> bookings
+    std::map<int, std::vector<int>> releases; // day a deferral ends -> donors per type
+    std::map<int, std::vector<int>> expiries; // first day a unit is unusable -> units per type
+
+    static int slot(int bloodType) {
+        return bloodType >= 0 && bloodType < BLOOD_TYPE_COUNT ? bloodType : BLOOD_TYPE_COUNT;
+    }
+
+    static void schedule(std::map<int, std::vector<int>>& days, int day, int type, int delta) {
+        std::vector<int>& counts = days[day];
+        if (counts.empty()) counts.assign(DASHBOARD_TYPES, 0);
+        counts[type] += delta;
+    }
+
+    // Deferred donors of a type (nextDay > today) are not eligible
+    void setDeferred(int type, int nextDay, int delta) {
+        if (nextDay <= today) return;
+        deferredByType[type] += delta;
+        schedule(releases, nextDay, type, delta);
+    }
+
+public:
+    void onDonorRegistered(int bloodType) {
+        int t = slot(bloodType);
+        state.donors++;
+        state.donorsByType[t]++;
+    }
+
+    void onAppointmentBooked(int day) {
+        appointmentsOn[day]++;
+    }
+
+    // A donor's next eligible day moved from `before` to `after`
+    // (INT_MIN = no restriction, INT_MAX = permanently deferred)
+    void onEligibilityChanged(int bloodType, int before, int after) {
+        int t = slot(bloodType);
+        setDeferred(t, before, -1);
+        setDeferred(t, after, +1);
+    }
+
+    void onUnitReceived(int bloodType, int expiryDay) {
+        if (expiryDay < today) return;
+        state.stockByType[bloodType]++;
+        schedule(expiries, expiryDay + 1, bloodType, 1);
+    }
+
+    // Units handed out by Inventory::issue (never expired ones)
+    void onUnitsIssued(const std::vector<BloodUnit>& units) {
+        for (const BloodUnit& u : units) {
+            if (u.expiryDay < today) continue;
+            state.stockByType[u.bloodType]--;
+            schedule(expiries, u.expiryDay + 1, u.bloodType, -1);
+        }
+    }
+
+    // Moves the clock to `day`, ending deferrals and unit lives that ran out
+    void advance(int day) {
+        if (day <= today) return;
+        today = day;
+        while (!releases.empty() && releases.begin()->first <= today) {
+            for (int t = 0; t < DASHBOARD_TYPES; t++) deferredByType[t] -= releases.begin()->second[t];
+            releases.erase(releases.begin());
+        }
+        while (!expiries.empty() && expiries.begin()->first <= today) {
+            for (int t = 0; t < BLOOD_TYPE_COUNT; t++) state.stockByType[t] -= expiries.begin()->second[t];
+            expiries.erase(expiries.begin());
+        }
+    }
+
+    // The overview as of `day` (advancing to it first)
+    DashboardSnapshot read(int day) {
+        advance(day);
+        DashboardSnapshot out = state;
+        out.day = today;
+        out.eligible = 0;
+        for (int t = 0; t < DASHBOARD_TYPES; t++) {
+            out.eligibleByType[t] = state.donorsByType[t] - deferredByType[t];
+            out.eligible += out.eligibleByType[t];
+        }
+        const int* booked = appointmentsOn.find(today);
+        out.appointmentsToday = booked ? *booked : 0;
+        out.appointmentsThisWeek = 0;
+        for (int d = today; d < today + 7; d++) {
+            if (const int* n = appointmentsOn.find(d)) out.appointmentsThisWeek += *n;
+        }
+        return out;
+    }
+};
+
+#endif
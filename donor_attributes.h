@@ -0,0 +1,132 @@
+// donor_attributes.h
+#ifndef DONOR_ATTRIBUTES_H
+#define DONOR_ATTRIBUTES_H
+
+// Donor population counts by attribute for supervisor reports.
+// Each value of gender, blood type, region, city and registration month has
+// a compressed bitmap of the donor ids that have it, so "female O- donors in
+// Amhara registered this year" is one union of the months and a multi-way
+// AND, counted with popcounts instead of scanning donors and comparing strings.
+// Values are matched case-insensitively.
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "containers.h"
+#include "roaring.h"
+
+enum DonorAttribute {
+    ATTR_GENDER,
+    ATTR_BLOOD_TYPE,
+    ATTR_REGION,
+    ATTR_CITY,
+    ATTR_COUNT
+};
+
+// Every non-empty field must match; months are "YYYY-MM", inclusive
+struct DonorFilter {
+    std::string values[ATTR_COUNT];
+    std::string fromMonth;
+    std::string toMonth;
+};
+
+class DonorAttributeIndex {
+private:
+    FlatHashMap<std::string, RoaringBitmap> byValue[ATTR_COUNT];
+    std::vector<std::string> valueNames[ATTR_COUNT]; // as first seen, for reports
+    std::map<std::string, RoaringBitmap> byMonth;    // "YYYY-MM" -> donors registered then
+    RoaringBitmap everyone;
+
+    static std::string fold(const std::string& value) {
+        std::string out = value;
+        for (char& ch : out) ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+        return out;
+    }
+
+    bool monthFiltered(const DonorFilter& f) const {
+        return !f.fromMonth.empty() || !f.toMonth.empty();
+    }
+
+    RoaringBitmap monthRange(const DonorFilter& f) const {
+        std::vector<const RoaringBitmap*> months;
+        auto it = f.fromMonth.empty() ? byMonth.begin() : byMonth.lower_bound(f.fromMonth);
+        for (; it != byMonth.end() && (f.toMonth.empty() || it->first <= f.toMonth); ++it) months.push_back(&it->second);
+        return RoaringBitmap::unionOf(months);
+    }
+
+    // Bitmaps that must all match, smallest first; false if a value is unknown
+    bool terms(const DonorFilter& f, RoaringBitmap& months, std::vector<const RoaringBitmap*>& out) const {
+        for (int a = 0; a < ATTR_COUNT; a++) {
+            if (f.values[a].empty()) continue;
+            const RoaringBitmap* b = byValue[a].find(fold(f.values[a]));
+            if (!b) return false;
+            out.push_back(b);
+        }
+        if (monthFiltered(f)) {
+            months = monthRange(f);
+            out.push_back(&months);
+        }
+        if (out.empty()) out.push_back(&everyone);
+        std::sort(out.begin(), out.end(), [](const RoaringBitmap* a, const RoaringBitmap* b) {
+            return a->cardinality() < b->cardinality();
+        });
+        return true;
+    }
+
+public:
+    // registeredOn is "YYYY-MM-DD"
+    void add(int donorId, const std::string& gender, const std::string& bloodType, const std::string& region,
+             const std::string& city, const std::string& registeredOn) {
+        const std::string* values[ATTR_COUNT] = {&gender, &bloodType, &region, &city};
+        uint32_t id = static_cast<uint32_t>(donorId);
+        for (int a = 0; a < ATTR_COUNT; a++) {
+            std::string key = fold(*values[a]);
+            if (!byValue[a].find(key)) valueNames[a].push_back(*values[a]);
+            byValue[a][key].add(id);
+        }
+        byMonth[registeredOn.substr(0, 7)].add(id);
+        everyone.add(id);
+    }
+
+    uint64_t count(const DonorFilter& f) const {
+        RoaringBitmap months;
+        std::vector<const RoaringBitmap*> t;
+        if (!terms(f, months, t)) return 0;
+        return RoaringBitmap::andCount(t);
+    }
+
+    // Donors matching the filter
+    RoaringBitmap matching(const DonorFilter& f) const {
+        RoaringBitmap months;
+        std::vector<const RoaringBitmap*> t;
+        if (!terms(f, months, t)) return RoaringBitmap();
+        RoaringBitmap out = *t[0];
+        for (size_t i = 1; i < t.size(); i++) out &= *t[i];
+        return out;
+    }
+
+    // Matching donors split by every value of one attribute, largest first
+    std::vector<std::pair<std::string, uint64_t>> countBy(const DonorFilter& f, DonorAttribute attribute) const {
+        RoaringBitmap months;
+        std::vector<const RoaringBitmap*> t;
+        std::vector<std::pair<std::string, uint64_t>> out;
+        if (!terms(f, months, t)) return out;
+        t.push_back(nullptr); // the value being counted
+        for (const std::string& name : valueNames[attribute]) {
+            t.back() = byValue[attribute].find(fold(name));
+            uint64_t n = RoaringBitmap::andCount(t);
+            if (n > 0) out.push_back({name, n});
+        }
+        std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+        return out;
+    }
+
+    uint64_t size() const {
+        return everyone.cardinality();
+    }
+};
+
+#endif
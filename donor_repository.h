@@ -0,0 +1,244 @@
+// donor_repository.h
+#ifndef DONOR_REPOSITORY_H
+#define DONOR_REPOSITORY_H
+
+// Donors and their appointments stored in PostgreSQL, with a read-through
+// cache in front. PgDonorRepository runs one prepared statement per call on
+// a blocking libpq connection. CachedDonorRepository serves logins and
+// profile views from two W-TinyLFU caches (donors, appointment lists) and
+// only goes to the database on a miss. Writes go to the database first; the
+// row it returns (defaults filled in) is then written through to the cache.
+// Neither class is thread-safe: one per connection, or callers lock.
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+#include "metrics.h"
+#include "tinylfu.h"
+
+struct DonorRecord {
+    std::string username;
+    std::string password;
+    std::string firstName;
+    std::string lastName;
+    std::string gender;
+    std::string phone;
+    std::string bloodType;
+    std::string email;
+    std::string city;
+    std::string region;
+    std::string kebele;
+    std::string worda;
+    std::string registeredOn; // YYYY-MM-DD
+};
+
+struct AppointmentRecord {
+    std::string date;
+    std::string time;
+    std::string message;
+};
+
+class PgDonorRepository {
+private:
+    PGconn* conn;
+    uint64_t queries = 0;
+
+    // Runs a prepared statement; the caller clears the result
+    PGresult* run(const char* statement, const std::vector<const std::string*>& params) {
+        std::vector<const char*> values;
+        for (const std::string* p : params) values.push_back(p->c_str());
+        queries++;
+        return PQexecPrepared(conn, statement, static_cast<int>(values.size()), values.data(), nullptr, nullptr, 0);
+    }
+
+    bool runCommand(const char* statement, const std::vector<const std::string*>& params) {
+        PGresult* res = run(statement, params);
+        bool ok = PQresultStatus(res) == PGRES_COMMAND_OK && std::atoi(PQcmdTuples(res)) == 1;
+        PQclear(res);
+        return ok;
+    }
+
+    // Runs a statement that returns at most one donor row; true if it did
+    bool runDonorRow(const char* statement, const std::vector<const std::string*>& params, DonorRecord& out) {
+        PGresult* res = run(statement, params);
+        bool found = PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) == 1;
+        if (found) {
+            std::string* fields[] = {&out.username, &out.password, &out.firstName, &out.lastName, &out.gender,
+                                     &out.phone, &out.bloodType, &out.email, &out.city, &out.region,
+                                     &out.kebele, &out.worda, &out.registeredOn};
+            for (int i = 0; i < 13; i++) fields[i]->assign(PQgetvalue(res, 0, i));
+        }
+        PQclear(res);
+        return found;
+    }
+
+    static std::vector<const std::string*> donorParams(const DonorRecord& d) {
+        return {&d.username, &d.password, &d.firstName, &d.lastName, &d.gender, &d.phone, &d.bloodType,
+                &d.email, &d.city, &d.region, &d.kebele, &d.worda, &d.registeredOn};
+    }
+
+public:
+    static constexpr const char* donorColumns =
+        " username, password, first_name, last_name, gender, phone, blood_type, email, city,"
+        " region, kebele, worda, registered_on::text";
+
+    static constexpr const char* schema =
+        "CREATE TABLE IF NOT EXISTS donors ("
+        " username text PRIMARY KEY, password text NOT NULL, first_name text, last_name text,"
+        " gender text, phone text, blood_type text, email text, city text, region text,"
+        " kebele text, worda text, registered_on date NOT NULL DEFAULT current_date);"
+        "CREATE TABLE IF NOT EXISTS appointments ("
+        " id bigserial PRIMARY KEY, username text NOT NULL REFERENCES donors(username),"
+        " date date NOT NULL, time text NOT NULL, message text);"
+        "CREATE INDEX IF NOT EXISTS appointments_by_donor ON appointments (username, date);";
+
+    explicit PgDonorRepository(PGconn* conn) : conn(conn) {}
+
+    // Creates the tables if needed and prepares the statements
+    bool prepare() {
+        PGresult* res = PQexec(conn, schema);
+        bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+        // Writes return the stored row, with the database's defaults filled in
+        std::string returning = std::string(" RETURNING") + donorColumns;
+        std::string findDonor = std::string("SELECT") + donorColumns + " FROM donors WHERE username = $1";
+        std::string insertDonor =
+            "INSERT INTO donors (username, password, first_name, last_name, gender, phone, blood_type, email,"
+            " city, region, kebele, worda, registered_on)"
+            " VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, COALESCE(NULLIF($13, '')::date, current_date))"
+            " ON CONFLICT (username) DO NOTHING" + returning;
+        std::string updateDonor =
+            "UPDATE donors SET password = $2, first_name = $3, last_name = $4, gender = $5, phone = $6,"
+            " blood_type = $7, email = $8, city = $9, region = $10, kebele = $11, worda = $12,"
+            " registered_on = COALESCE(NULLIF($13, '')::date, registered_on) WHERE username = $1" + returning;
+        const char* statements[][2] = {
+            {"find_donor", findDonor.c_str()},
+            {"donor_appointments",
+             "SELECT date::text, time, message FROM appointments WHERE username = $1 ORDER BY date, time"},
+            {"insert_donor", insertDonor.c_str()},
+            {"update_donor", updateDonor.c_str()},
+            {"insert_appointment",
+             "INSERT INTO appointments (username, date, time, message) VALUES ($1, $2::date, $3, $4)"}};
+        for (const auto& s : statements) {
+            if (!ok) break;
+            res = PQprepare(conn, s[0], s[1], 0, nullptr);
+            ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+            PQclear(res);
+        }
+        return ok;
+    }
+
+    bool findDonor(const std::string& username, DonorRecord& out) {
+        TIME_OPERATION("donor_store_find");
+        return runDonorRow("find_donor", {&username}, out);
+    }
+
+    // False only if the query failed; a donor without appointments gets an empty list
+    bool appointmentsFor(const std::string& username, std::vector<AppointmentRecord>& out) {
+        TIME_OPERATION("donor_store_appointments");
+        PGresult* res = run("donor_appointments", {&username});
+        bool ok = PQresultStatus(res) == PGRES_TUPLES_OK;
+        out.clear();
+        for (int row = 0; ok && row < PQntuples(res); row++) {
+            out.push_back({PQgetvalue(res, row, 0), PQgetvalue(res, row, 1), PQgetvalue(res, row, 2)});
+        }
+        PQclear(res);
+        return ok;
+    }
+
+    // False if the username is taken or the insert failed. `stored`
+    // receives the row as inserted (registeredOn defaults to today).
+    bool insertDonor(const DonorRecord& d, DonorRecord& stored) {
+        TIME_OPERATION("donor_store_insert");
+        return runDonorRow("insert_donor", donorParams(d), stored);
+    }
+
+    // False if there is no such donor or the update failed. `stored`
+    // receives the row as updated (an empty registeredOn keeps the old date).
+    bool updateDonor(const DonorRecord& d, DonorRecord& stored) {
+        TIME_OPERATION("donor_store_update");
+        return runDonorRow("update_donor", donorParams(d), stored);
+    }
+
+    bool insertAppointment(const std::string& username, const AppointmentRecord& a) {
+        TIME_OPERATION("donor_store_book");
+        return runCommand("insert_appointment", {&username, &a.date, &a.time, &a.message});
+    }
+
+    // Round trips made so far
+    uint64_t queryCount() const {
+        return queries;
+    }
+
+    std::string errorMessage() const {
+        return PQerrorMessage(conn);
+    }
+};
+
+class CachedDonorRepository {
+private:
+    PgDonorRepository& store;
+    TinyLfuCache<std::string, DonorRecord> donors;
+    TinyLfuCache<std::string, std::vector<AppointmentRecord>> appointments;
+
+public:
+    CachedDonorRepository(PgDonorRepository& store, size_t donorCapacity, size_t appointmentCapacity)
+        : store(store), donors(donorCapacity), appointments(appointmentCapacity) {}
+
+    // The donor, or nullptr if there is none. Valid until the next call.
+    const DonorRecord* findDonor(const std::string& username) {
+        TIME_OPERATION("donor_cache_find");
+        return donors.get(username, [&](DonorRecord& d) { return store.findDonor(username, d); });
+    }
+
+    // Checks a login against the cached donor
+    const DonorRecord* login(const std::string& username, const std::string& password) {
+        const DonorRecord* d = findDonor(username);
+        return d && d->password == password ? d : nullptr;
+    }
+
+    // The donor's appointments by date, or nullptr if the query failed. Valid until the next call.
+    const std::vector<AppointmentRecord>* appointmentsFor(const std::string& username) {
+        TIME_OPERATION("donor_cache_appointments");
+        return appointments.get(username, [&](std::vector<AppointmentRecord>& list) {
+            return store.appointmentsFor(username, list);
+        });
+    }
+
+    // The row the database stored is cached, not `d`, so defaults match
+    bool registerDonor(const DonorRecord& d) {
+        DonorRecord stored;
+        if (!store.insertDonor(d, stored)) return false;
+        donors.put(d.username, std::move(stored));
+        return true;
+    }
+
+    bool updateDonor(const DonorRecord& d) {
+        DonorRecord stored;
+        if (!store.updateDonor(d, stored)) {
+            donors.invalidate(d.username); // it may be gone from the database
+            return false;
+        }
+        donors.put(d.username, std::move(stored));
+        return true;
+    }
+
+    // The cached list is dropped rather than patched, so it is re-read in date order
+    bool bookAppointment(const std::string& username, const AppointmentRecord& a) {
+        bool ok = store.insertAppointment(username, a);
+        appointments.invalidate(username);
+        return ok;
+    }
+
+    const CacheStats& donorStats() const {
+        return donors.stats();
+    }
+
+    const CacheStats& appointmentStats() const {
+        return appointments.stats();
+    }
+};
+
+#endif
@@ -0,0 +1,179 @@
+// donor_search.h
+#ifndef DONOR_SEARCH_H
+#define DONOR_SEARCH_H
+
+// Fuzzy donor lookup over names and locations.
+// Each donor's text fields are split into lowercase words and every word into
+// trigrams, padded as "  w", " wo", ..., "rd " so short words and word starts
+// count too. An inverted index maps each trigram to the ids of the donors
+// that have it. Ids only grow, so a posting list is stored as varint deltas
+// (usually one byte per donor) and adding a donor just appends to the lists
+// of its trigrams.
+//
+// A search counts, for every donor sharing a trigram with the query, how many
+// it shares, and ranks them by trigram similarity (shared / union), so
+// "abebe bahirdar" still finds "Abebe ... Bahir Dar". Only the lists of the
+// query's trigrams are read, each one front to back.
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+#include "containers.h"
+
+class DonorSearchIndex {
+public:
+    struct Match {
+        int id;
+        float score; // 0..1, 1 = same trigrams
+    };
+
+private:
+    struct Posting {
+        std::vector<uint8_t> bytes; // varint deltas between ids
+        int last = -1;
+    };
+
+    // Lower score first, so the heap top is the weakest match kept
+    struct WeakerMatch {
+        bool operator()(const Match& a, const Match& b) const {
+            return a.score != b.score ? a.score < b.score : a.id > b.id;
+        }
+    };
+
+    FlatHashMap<uint32_t, Posting> postings;
+    std::vector<uint16_t> trigramCounts; // distinct trigrams per donor id
+    size_t bytesUsed = 0;
+
+    // Search scratch, kept between calls so a search doesn't clear millions of counters
+    mutable std::vector<uint16_t> shared;
+    mutable std::vector<int> touched;
+
+    static char fold(char ch) {
+        if (ch >= 'A' && ch <= 'Z') return static_cast<char>(ch - 'A' + 'a');
+        if ((ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9')) return ch;
+        return ' ';
+    }
+
+    static uint32_t pack(char a, char b, char c) {
+        return (static_cast<uint32_t>(static_cast<uint8_t>(a)) << 16) |
+               (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) | static_cast<uint8_t>(c);
+    }
+
+    // Appends the trigrams of every word in text (not deduplicated)
+    static void addTrigrams(std::string_view text, std::vector<uint32_t>& out) {
+        char prev2 = ' ', prev1 = ' ';
+        for (size_t i = 0; i <= text.size(); i++) {
+            char ch = i < text.size() ? fold(text[i]) : ' ';
+            if (ch == ' ' && prev1 == ' ') continue; // between words
+            out.push_back(pack(prev2, prev1, ch));
+            prev2 = ch == ' ' ? ' ' : prev1;
+            prev1 = ch;
+        }
+    }
+
+    static void sortUnique(std::vector<uint32_t>& v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+
+    static void putVarint(std::vector<uint8_t>& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static uint32_t getVarint(const uint8_t*& in) {
+        uint32_t v = *in++;
+        if (v & 0x80) { // rare on busy lists, where ids are close together
+            v &= 0x7F;
+            int shift = 7;
+            while (*in & 0x80) {
+                v |= static_cast<uint32_t>(*in++ & 0x7F) << shift;
+                shift += 7;
+            }
+            v |= static_cast<uint32_t>(*in++) << shift;
+        }
+        return v;
+    }
+
+public:
+    // Indexes a donor. Ids must be added in increasing order (donorsById order).
+    void add(int id, std::initializer_list<std::string_view> fields) {
+        if (id < static_cast<int>(trigramCounts.size())) return;
+        std::vector<uint32_t> grams;
+        for (std::string_view field : fields) addTrigrams(field, grams);
+        sortUnique(grams);
+
+        trigramCounts.resize(id + 1, 0);
+        trigramCounts[id] = static_cast<uint16_t>(std::min<size_t>(grams.size(), UINT16_MAX));
+        for (uint32_t g : grams) {
+            Posting& p = postings[g];
+            size_t before = p.bytes.size();
+            putVarint(p.bytes, static_cast<uint32_t>(id - p.last));
+            bytesUsed += p.bytes.size() - before;
+            p.last = id;
+        }
+    }
+
+    // Best matches for free text, highest score first (ties: lower id first)
+    std::vector<Match> search(std::string_view text, size_t limit = 10) const {
+        std::vector<uint32_t> grams;
+        addTrigrams(text, grams);
+        sortUnique(grams);
+        if (grams.empty() || limit == 0) return {};
+        if (grams.size() > UINT16_MAX) grams.resize(UINT16_MAX);
+
+        if (shared.size() < trigramCounts.size()) shared.resize(trigramCounts.size(), 0);
+        for (uint32_t g : grams) {
+            const Posting* p = postings.find(g);
+            if (!p) continue;
+            const uint8_t* in = p->bytes.data();
+            const uint8_t* end = in + p->bytes.size();
+            int id = -1;
+            while (in < end) {
+                id += static_cast<int>(getVarint(in));
+                if (shared[id]++ == 0) touched.push_back(id);
+            }
+        }
+
+        // Keep the best `limit` in a min-heap on score
+        DaryHeap<Match, WeakerMatch> best;
+        best.reserve(limit + 1);
+        float queryCount = static_cast<float>(grams.size());
+        for (int id : touched) {
+            float both = shared[id];
+            shared[id] = 0;
+            Match m{id, both / (queryCount + trigramCounts[id] - both)};
+            if (best.size() < limit) {
+                best.push(m);
+            } else if (WeakerMatch()(best.top(), m)) {
+                best.pop();
+                best.push(m);
+            }
+        }
+        touched.clear();
+
+        std::vector<Match> out(best.size());
+        for (size_t i = out.size(); i-- > 0;) out[i] = best.pop();
+        return out;
+    }
+
+    size_t size() const {
+        return trigramCounts.size();
+    }
+
+    size_t trigramCount() const {
+        return postings.size();
+    }
+
+    // Bytes taken by the compressed posting lists
+    size_t postingBytes() const {
+        return bytesUsed;
+    }
+};
+
+#endif
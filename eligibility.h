@@ -0,0 +1,143 @@
+// eligibility.h
+#ifndef ELIGIBILITY_H
+#define ELIGIBILITY_H
+
+// Tracks the next day each donor may donate again.
+// Donations and health events only ever push a donor's next-eligible day
+// later, so each event is an O(log n) update of one donor. Donors who are not
+// yet eligible sit in an indexed min-heap keyed by that day; advance(today)
+// pops the ones whose wait is over, so "who becomes eligible between two
+// days" walks only the part of the heap that is inside the range.
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "containers.h"
+#include "health_store.h"
+
+// Days a donor must wait after each kind of event
+struct DeferralPolicy {
+    int afterDonation = 56;      // whole blood, 8 weeks
+    int lowHemoglobin = 30;
+    int highBloodPressure = 14;
+    int illness = 14;
+    int medication = 7;
+    int travel = 28;
+};
+
+class EligibilityTracker {
+private:
+    static constexpr int NOT_IN_HEAP = -1;
+
+    struct SoonerEligible {
+        const std::vector<int>* nextDay;
+        bool operator()(int a, int b) const { return (*nextDay)[a] < (*nextDay)[b]; }
+    };
+
+    struct HeapSlot {
+        std::vector<int>* heapPos;
+        void operator()(int id, size_t pos) const {
+            (*heapPos)[id] = pos == SIZE_MAX ? NOT_IN_HEAP : static_cast<int>(pos);
+        }
+    };
+
+    using DonorHeap = DaryHeap<int, SoonerEligible, 4, HeapSlot>;
+
+    DeferralPolicy policy;
+    std::vector<int> nextDay;      // next eligible day per donor id (INT_MIN = no restriction)
+    std::vector<int> lastDonation; // INT_MIN = never
+    std::vector<int> heapPos;      // position in heap or NOT_IN_HEAP
+    DonorHeap heap{SoonerEligible{&nextDay}, HeapSlot{&heapPos}}; // donor ids, min-heap on nextDay
+    int today = INT_MIN;           // last day passed to advance()
+
+    void ensure(int id) {
+        if (id >= static_cast<int>(nextDay.size())) {
+            nextDay.resize(id + 1, INT_MIN);
+            lastDonation.resize(id + 1, INT_MIN);
+            heapPos.resize(id + 1, NOT_IN_HEAP);
+        }
+    }
+
+    // Moves a donor's next-eligible day later (never earlier)
+    void defer(int id, int untilDay) {
+        ensure(id);
+        if (untilDay <= nextDay[id]) return;
+        nextDay[id] = untilDay;
+        if (untilDay <= today) return; // already over
+        if (heapPos[id] == NOT_IN_HEAP) heap.push(id);
+        else heap.update(heapPos[id]); // key only grows
+    }
+
+    void collect(size_t i, int from, int to, std::vector<int>& out) const {
+        if (i >= heap.size() || nextDay[heap[i]] > to) return; // children are later still
+        if (nextDay[heap[i]] >= from) out.push_back(heap[i]);
+        size_t child = DonorHeap::firstChild(i);
+        for (size_t c = child; c < child + DonorHeap::arity; c++) collect(c, from, to, out);
+    }
+
+public:
+    EligibilityTracker() {}
+    explicit EligibilityTracker(const DeferralPolicy& policy) : policy(policy) {}
+
+    // The heap points at nextDay and heapPos
+    EligibilityTracker(const EligibilityTracker&) = delete;
+    EligibilityTracker& operator=(const EligibilityTracker&) = delete;
+
+    // A donation was taken on the given day
+    void onDonation(int id, int day) {
+        ensure(id);
+        if (day > lastDonation[id]) lastDonation[id] = day;
+        defer(id, day + policy.afterDonation);
+    }
+
+    // A health reading or status arrived
+    void onHealthEvent(int id, int day, uint8_t flags) {
+        if (flags & FLAG_DONATED) onDonation(id, day);
+        if (flags & FLAG_LOW_HEMOGLOBIN) defer(id, day + policy.lowHemoglobin);
+        if (flags & FLAG_HIGH_BLOOD_PRESSURE) defer(id, day + policy.highBloodPressure);
+        if (flags & FLAG_ILLNESS) defer(id, day + policy.illness);
+        if (flags & FLAG_MEDICATION) defer(id, day + policy.medication);
+        if (flags & FLAG_TRAVEL) defer(id, day + policy.travel);
+        if (flags & FLAG_PERMANENT_DEFERRAL) defer(id, INT_MAX);
+    }
+
+    // Moves the clock forward, releasing donors whose deferral has ended.
+    // Returns how many became eligible.
+    int advance(int day) {
+        if (day > today) today = day;
+        int released = 0;
+        while (!heap.empty() && nextDay[heap.top()] <= today) {
+            heap.pop();
+            released++;
+        }
+        return released;
+    }
+
+    bool isEligibleOn(int id, int day) const {
+        return id >= static_cast<int>(nextDay.size()) || nextDay[id] <= day;
+    }
+
+    // INT_MIN if the donor may donate any time, INT_MAX if permanently deferred
+    int nextEligibleDay(int id) const {
+        return id < static_cast<int>(nextDay.size()) ? nextDay[id] : INT_MIN;
+    }
+
+    int lastDonationDay(int id) const {
+        return id < static_cast<int>(lastDonation.size()) ? lastDonation[id] : INT_MIN;
+    }
+
+    // Donors whose deferral ends in [from, to], after advancing to from - 1
+    std::vector<int> becomingEligible(int from, int to) {
+        advance(from - 1);
+        std::vector<int> out;
+        collect(0, from, to, out);
+        return out;
+    }
+
+    // Donors still waiting as of the last advance()
+    int deferredCount() const {
+        return static_cast<int>(heap.size());
+    }
+};
+
+#endif
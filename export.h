@@ -0,0 +1,329 @@
+// export.h
+#ifndef EXPORT_H
+#define EXPORT_H
+
+// Streams table rows to a file descriptor (file, pipe or stdout) as CSV,
+// JSON Lines or a binary columnar file, without building strings per field.
+// Numbers are formatted with std::to_chars into one preallocated buffer.
+// String fields that need no escaping and are long enough are not copied at
+// all: the output is a list of iovecs pointing into that buffer and straight
+// at the caller's strings, handed to writev() in batches. So every string
+// passed to field() must stay alive and unchanged until the next flush()
+// (finish() flushes).
+//
+// Columnar layout (little-endian):
+//   "COL1" u32 columns, u64 rows
+//   per column: u8 type (0 = int64, 1 = string), u32 name length, name
+//   per column: int64 values, or u64 end offsets followed by the string bytes
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+enum ExportFormat {
+    EXPORT_CSV,
+    EXPORT_JSONL,
+    EXPORT_COLUMNAR
+};
+
+// Parses "csv", "jsonl" or "columnar"; returns false for anything else
+inline bool exportFormatFromName(const std::string& name, ExportFormat& format) {
+    if (name == "csv") format = EXPORT_CSV;
+    else if (name == "jsonl") format = EXPORT_JSONL;
+    else if (name == "columnar") format = EXPORT_COLUMNAR;
+    else return false;
+    return true;
+}
+
+enum ColumnType : uint8_t {
+    COLUMN_INT = 0,
+    COLUMN_STRING = 1
+};
+
+struct ExportColumn {
+    const char* name;
+    ColumnType type;
+};
+
+class ExportWriter {
+private:
+    static constexpr size_t bufferSize = 1 << 16;
+    static constexpr size_t maxBatch = 512;  // iovecs per writev call
+    static constexpr size_t zeroCopyMin = 32; // shorter strings are cheaper to copy
+
+    struct Slice {
+        const char* data;
+        size_t size;
+    };
+
+    int fd;
+    ExportFormat format;
+    std::vector<ExportColumn> columns;
+    std::vector<std::string> jsonKeys; // {"name": / ,"name": per column
+
+    std::vector<char> buffer; // never reallocated, slices point into it
+    size_t used = 0;
+    size_t sliceStart = 0;    // start of the buffer bytes not yet in a slice
+    std::vector<Slice> slices;
+    size_t column = 0;        // next column in the current row
+    uint64_t rows = 0;
+    bool failed = false;
+
+    // Columnar mode keeps every value until finish()
+    std::vector<std::vector<int64_t>> intColumns;
+    std::vector<std::vector<std::string_view>> stringColumns;
+    std::vector<std::vector<uint64_t>> offsetColumns;
+
+    void closeSlice() {
+        if (used > sliceStart) slices.push_back({buffer.data() + sliceStart, used - sliceStart});
+        sliceStart = used;
+    }
+
+    bool writeAll(const Slice* s, size_t count) {
+#ifdef _WIN32
+        for (size_t i = 0; i < count; i++) {
+            const char* p = s[i].data;
+            size_t left = s[i].size;
+            while (left > 0) {
+                int n = _write(fd, p, static_cast<unsigned>(left));
+                if (n <= 0) return false;
+                p += n;
+                left -= n;
+            }
+        }
+        return true;
+#else
+        iovec iov[maxBatch];
+        size_t done = 0;
+        while (done < count) {
+            size_t n = 0;
+            for (; n < maxBatch && done + n < count; n++) {
+                iov[n].iov_base = const_cast<char*>(s[done + n].data);
+                iov[n].iov_len = s[done + n].size;
+            }
+            // writev may stop early (pipes); advance through partly written iovecs
+            size_t first = 0;
+            while (first < n) {
+                ssize_t w = writev(fd, iov + first, static_cast<int>(n - first));
+                if (w < 0) return false;
+                size_t left = static_cast<size_t>(w);
+                while (first < n && left >= iov[first].iov_len) left -= iov[first++].iov_len;
+                if (first < n) {
+                    iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+                    iov[first].iov_len -= left;
+                }
+            }
+            done += n;
+        }
+        return true;
+#endif
+    }
+
+    // Makes room for n more bytes in the buffer
+    void reserve(size_t n) {
+        if (used + n > buffer.size() || slices.size() >= maxBatch) flush();
+        if (n > buffer.size()) buffer.resize(n); // only right after a flush, nothing points into it
+    }
+
+    void put(const char* data, size_t n) {
+        reserve(n);
+        memcpy(buffer.data() + used, data, n);
+        used += n;
+    }
+
+    void put(char ch) {
+        reserve(1);
+        buffer[used++] = ch;
+    }
+
+    // Zero-copy: the string goes out from the caller's memory
+    void reference(std::string_view s) {
+        if (slices.size() + 2 > maxBatch) flush();
+        closeSlice();
+        slices.push_back({s.data(), s.size()});
+    }
+
+    void putInt(int64_t v) {
+        reserve(24);
+        auto r = std::to_chars(buffer.data() + used, buffer.data() + used + 24, v);
+        used = r.ptr - buffer.data();
+    }
+
+    void putCsv(std::string_view s) {
+        if (s.find_first_of(",\"\r\n") == std::string_view::npos) {
+            if (s.size() >= zeroCopyMin) reference(s);
+            else put(s.data(), s.size());
+            return;
+        }
+        put('"');
+        for (char ch : s) {
+            if (ch == '"') put('"');
+            put(ch);
+        }
+        put('"');
+    }
+
+    void putJson(std::string_view s) {
+        put('"');
+        bool plain = true;
+        for (char ch : s) {
+            if (ch == '"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20) {
+                plain = false;
+                break;
+            }
+        }
+        if (plain && s.size() >= zeroCopyMin) {
+            reference(s);
+        } else if (plain) {
+            put(s.data(), s.size());
+        } else {
+            static const char hex[] = "0123456789abcdef";
+            for (char ch : s) {
+                unsigned char c = static_cast<unsigned char>(ch);
+                if (ch == '"' || ch == '\\') {
+                    put('\\');
+                    put(ch);
+                } else if (ch == '\n') {
+                    put("\\n", 2);
+                } else if (ch == '\t') {
+                    put("\\t", 2);
+                } else if (c < 0x20) {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+                    put(esc, 6);
+                } else {
+                    put(ch);
+                }
+            }
+        }
+        put('"');
+    }
+
+    void beginField() {
+        if (format == EXPORT_CSV) {
+            if (column > 0) put(',');
+        } else if (format == EXPORT_JSONL) {
+            put(jsonKeys[column].data(), jsonKeys[column].size());
+        }
+    }
+
+    void endField() {
+        if (++column < columns.size()) return;
+        column = 0;
+        rows++;
+        if (format == EXPORT_CSV) put('\n');
+        else if (format == EXPORT_JSONL) put("}\n", 2);
+    }
+
+    template <typename T>
+    void putRaw(const T& v) {
+        put(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void finishColumnar() {
+        put("COL1", 4);
+        putRaw(static_cast<uint32_t>(columns.size()));
+        putRaw(rows);
+        for (const ExportColumn& c : columns) {
+            putRaw(static_cast<uint8_t>(c.type));
+            uint32_t len = static_cast<uint32_t>(strlen(c.name));
+            putRaw(len);
+            put(c.name, len);
+        }
+        for (size_t i = 0; i < columns.size(); i++) {
+            if (columns[i].type == COLUMN_INT) {
+                const std::vector<int64_t>& values = intColumns[i];
+                reference(std::string_view(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int64_t)));
+                continue;
+            }
+            const std::vector<std::string_view>& values = stringColumns[i];
+            std::vector<uint64_t>& offsets = offsetColumns[i];
+            uint64_t end = 0;
+            for (std::string_view s : values) {
+                end += s.size();
+                offsets.push_back(end);
+            }
+            reference(std::string_view(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t)));
+            for (std::string_view s : values) {
+                if (s.size() >= zeroCopyMin) reference(s);
+                else put(s.data(), s.size());
+            }
+        }
+    }
+
+public:
+    ExportWriter(int fd, ExportFormat format, const std::vector<ExportColumn>& columns)
+        : fd(fd), format(format), columns(columns), buffer(bufferSize) {
+        slices.reserve(maxBatch);
+        if (format == EXPORT_CSV) {
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (i > 0) put(',');
+                put(columns[i].name, strlen(columns[i].name));
+            }
+            put('\n');
+        } else if (format == EXPORT_JSONL) {
+            for (size_t i = 0; i < columns.size(); i++) {
+                jsonKeys.push_back(std::string(i == 0 ? "{\"" : ",\"") + columns[i].name + "\":");
+            }
+        } else {
+            intColumns.resize(columns.size());
+            stringColumns.resize(columns.size());
+            offsetColumns.resize(columns.size());
+        }
+    }
+
+    ExportWriter(const ExportWriter&) = delete;
+    ExportWriter& operator=(const ExportWriter&) = delete;
+
+    // Call once per column, in column order
+    void field(int64_t v) {
+        if (format == EXPORT_COLUMNAR) {
+            intColumns[column].push_back(v);
+        } else {
+            beginField();
+            putInt(v);
+        }
+        endField();
+    }
+
+    void field(std::string_view s) {
+        if (format == EXPORT_COLUMNAR) {
+            stringColumns[column].push_back(s);
+        } else {
+            beginField();
+            if (format == EXPORT_CSV) putCsv(s);
+            else putJson(s);
+        }
+        endField();
+    }
+
+    // Writes everything queued so far. Returns false once any write failed.
+    bool flush() {
+        closeSlice();
+        if (!failed && !slices.empty()) failed = !writeAll(slices.data(), slices.size());
+        slices.clear();
+        used = sliceStart = 0;
+        return !failed;
+    }
+
+    bool finish() {
+        if (format == EXPORT_COLUMNAR) finishColumnar();
+        return flush();
+    }
+
+    uint64_t rowCount() const {
+        return rows;
+    }
+};
+
+#endif
@@ -0,0 +1,211 @@
+// health_store.h
+#ifndef HEALTH_STORE_H
+#define HEALTH_STORE_H
+
+// Per-donor medical history stored as a columnar time series.
+// Each donor's readings are kept as separate columns (day, hemoglobin,
+// systolic, diastolic, flags), each a stream of zig-zag varint deltas against
+// the previous reading, so a typical reading costs a handful of bytes.
+// Every series also keeps a small summary (first/last day, lowest Hb, OR of
+// all flags) that lets cohort scans skip donors without decoding anything.
+// Cohort scans decode only the columns a query needs into flat arrays and
+// then test them in tight loops the compiler can vectorize.
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Health flags recorded with a reading
+enum HealthFlag : uint8_t {
+    FLAG_DONATED = 1 << 0,         // a donation was taken at this visit
+    FLAG_LOW_HEMOGLOBIN = 1 << 1,
+    FLAG_HIGH_BLOOD_PRESSURE = 1 << 2,
+    FLAG_ILLNESS = 1 << 3,
+    FLAG_MEDICATION = 1 << 4,
+    FLAG_TRAVEL = 1 << 5,
+    FLAG_PERMANENT_DEFERRAL = 1 << 6
+};
+
+struct HealthReading {
+    int day = 0;         // days since 1970-01-01
+    int hemoglobin = 0;  // g/dL x 10, 0 = not measured
+    int systolic = 0;    // mmHg, 0 = not measured
+    int diastolic = 0;   // mmHg, 0 = not measured
+    uint8_t flags = 0;   // HealthFlag bits
+};
+
+// "Any reading in [fromDay, toDay] matching every condition that is set"
+struct CohortQuery {
+    int fromDay = INT_MIN;
+    int toDay = INT_MAX;
+    int hemoglobinBelow = 0;   // 0 = no condition; unmeasured readings never match
+    int systolicAbove = 0;     // 0 = no condition
+    uint8_t anyFlags = 0;      // 0 = no condition
+};
+
+class HealthStore {
+private:
+    struct Series {
+        std::vector<uint8_t> days, hemoglobin, systolic, diastolic, flags;
+        int count = 0;
+        HealthReading last;     // previous values the deltas are taken against
+        int firstDay = INT_MAX;
+        int minHemoglobin = INT_MAX; // lowest measured value
+        uint8_t allFlags = 0;
+    };
+
+    std::vector<Series> series; // indexed by donor id
+
+    static void putVarint(std::vector<uint8_t>& col, int delta) {
+        uint32_t v = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31); // zig-zag
+        while (v >= 0x80) {
+            col.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        col.push_back(static_cast<uint8_t>(v));
+    }
+
+    // Decodes a whole delta column into out (one int per reading)
+    static void decodeColumn(const std::vector<uint8_t>& col, int count, std::vector<int>& out) {
+        out.resize(count);
+        const uint8_t* p = col.data();
+        int value = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t v = 0;
+            int shift = 0;
+            while (*p & 0x80) {
+                v |= static_cast<uint32_t>(*p++ & 0x7F) << shift;
+                shift += 7;
+            }
+            v |= static_cast<uint32_t>(*p++) << shift;
+            value += static_cast<int>((v >> 1) ^ (~(v & 1) + 1));
+            out[i] = value;
+        }
+    }
+
+    static void append(Series& s, const HealthReading& r) {
+        putVarint(s.days, r.day - s.last.day);
+        putVarint(s.hemoglobin, r.hemoglobin - s.last.hemoglobin);
+        putVarint(s.systolic, r.systolic - s.last.systolic);
+        putVarint(s.diastolic, r.diastolic - s.last.diastolic);
+        s.flags.push_back(r.flags);
+        s.last = r;
+        s.count++;
+        if (r.day < s.firstDay) s.firstDay = r.day;
+        if (r.hemoglobin > 0 && r.hemoglobin < s.minHemoglobin) s.minHemoglobin = r.hemoglobin;
+        s.allFlags |= r.flags;
+    }
+
+    Series& seriesFor(int donorId) {
+        if (donorId >= static_cast<int>(series.size())) series.resize(donorId + 1);
+        return series[donorId];
+    }
+
+public:
+    // Adds a reading. Readings normally arrive in date order; an older one
+    // makes the donor's series be re-encoded in order.
+    void record(int donorId, const HealthReading& reading) {
+        Series& s = seriesFor(donorId);
+        if (s.count == 0 || reading.day >= s.last.day) {
+            append(s, reading);
+            return;
+        }
+
+        std::vector<HealthReading> all = history(donorId);
+        size_t pos = 0;
+        while (pos < all.size() && all[pos].day <= reading.day) pos++;
+        all.insert(all.begin() + pos, reading);
+        s = Series();
+        for (const auto& r : all) append(s, r);
+    }
+
+    // All readings of a donor, oldest first
+    std::vector<HealthReading> history(int donorId) const {
+        std::vector<HealthReading> out;
+        if (donorId < 0 || donorId >= static_cast<int>(series.size())) return out;
+        const Series& s = series[donorId];
+        std::vector<int> days, hb, sys, dia;
+        decodeColumn(s.days, s.count, days);
+        decodeColumn(s.hemoglobin, s.count, hb);
+        decodeColumn(s.systolic, s.count, sys);
+        decodeColumn(s.diastolic, s.count, dia);
+        out.resize(s.count);
+        for (int i = 0; i < s.count; i++) {
+            out[i].day = days[i];
+            out[i].hemoglobin = hb[i];
+            out[i].systolic = sys[i];
+            out[i].diastolic = dia[i];
+            out[i].flags = s.flags[i];
+        }
+        return out;
+    }
+
+    // Most recent reading, without decoding the series
+    bool latest(int donorId, HealthReading& out) const {
+        if (donorId < 0 || donorId >= static_cast<int>(series.size()) || series[donorId].count == 0) return false;
+        out = series[donorId].last;
+        return true;
+    }
+
+    int readingCount(int donorId) const {
+        if (donorId < 0 || donorId >= static_cast<int>(series.size())) return 0;
+        return series[donorId].count;
+    }
+
+    // Ids of donors with at least one reading matching the query
+    std::vector<int> cohort(const CohortQuery& q) const {
+        std::vector<int> result;
+        std::vector<int> days, hb, sys;
+        std::vector<uint8_t> match;
+
+        for (int id = 0; id < static_cast<int>(series.size()); id++) {
+            const Series& s = series[id];
+            // Summary checks first: most donors are skipped here
+            if (s.count == 0 || s.last.day < q.fromDay || s.firstDay > q.toDay) continue;
+            if (q.hemoglobinBelow > 0 && s.minHemoglobin >= q.hemoglobinBelow) continue;
+            if (q.anyFlags != 0 && (s.allFlags & q.anyFlags) == 0) continue;
+
+            int n = s.count;
+            match.assign(n, 1);
+            decodeColumn(s.days, n, days);
+            for (int i = 0; i < n; i++) {
+                match[i] &= static_cast<uint8_t>((days[i] >= q.fromDay) & (days[i] <= q.toDay));
+            }
+            if (q.hemoglobinBelow > 0) {
+                decodeColumn(s.hemoglobin, n, hb);
+                for (int i = 0; i < n; i++) {
+                    match[i] &= static_cast<uint8_t>((hb[i] > 0) & (hb[i] < q.hemoglobinBelow));
+                }
+            }
+            if (q.systolicAbove > 0) {
+                decodeColumn(s.systolic, n, sys);
+                for (int i = 0; i < n; i++) {
+                    match[i] &= static_cast<uint8_t>(sys[i] > q.systolicAbove);
+                }
+            }
+            if (q.anyFlags != 0) {
+                const uint8_t* f = s.flags.data();
+                for (int i = 0; i < n; i++) {
+                    match[i] &= static_cast<uint8_t>((f[i] & q.anyFlags) != 0);
+                }
+            }
+
+            uint8_t any = 0;
+            for (int i = 0; i < n; i++) any |= match[i];
+            if (any) result.push_back(id);
+        }
+        return result;
+    }
+
+    // Bytes used by the encoded columns (for capacity planning)
+    size_t encodedBytes() const {
+        size_t total = 0;
+        for (const auto& s : series) {
+            total += s.days.size() + s.hemoglobin.size() + s.systolic.size() + s.diastolic.size() + s.flags.size();
+        }
+        return total;
+    }
+};
+
+#endif
@@ -0,0 +1,390 @@
+// http_server.h
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+// Small HTTP/1.1 server used for the blood bank's server mode.
+// One epoll event loop per core, each with its own SO_REUSEPORT listening
+// socket so the kernel spreads connections across loops. Sockets are
+// non-blocking, connections are kept alive and pipelined requests are served
+// in order. Linux only.
+
+#include <cctype>
+#include <string>
+#include <vector>
+#include <functional>
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string query;
+    std::vector<std::pair<std::string, std::string>> headers; // names lower-cased
+    std::string body;
+
+    // Returns the header value or "" if missing (name must be lower-case)
+    std::string header(const std::string& name) const {
+        for (const auto& h : headers) {
+            if (h.first == name) return h.second;
+        }
+        return "";
+    }
+
+    // Returns a decoded query string parameter or "" if missing
+    std::string param(const std::string& name) const {
+        size_t pos = 0;
+        while (pos <= query.size()) {
+            size_t end = query.find('&', pos);
+            if (end == std::string::npos) end = query.size();
+            size_t eq = query.find('=', pos);
+            if (eq != std::string::npos && eq < end && query.compare(pos, eq - pos, name) == 0 && eq - pos == name.size()) {
+                std::string value;
+                for (size_t i = eq + 1; i < end; i++) {
+                    if (query[i] == '+') {
+                        value += ' ';
+                    } else if (query[i] == '%' && i + 2 < end &&
+                               isxdigit(static_cast<unsigned char>(query[i + 1])) &&
+                               isxdigit(static_cast<unsigned char>(query[i + 2]))) {
+                        value += static_cast<char>(std::stoi(query.substr(i + 1, 2), nullptr, 16));
+                        i += 2;
+                    } else {
+                        value += query[i];
+                    }
+                }
+                return value;
+            }
+            pos = end + 1;
+        }
+        return "";
+    }
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+};
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+#ifdef __linux__
+
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+class HttpServer {
+private:
+    struct Connection {
+        std::string in;   // bytes read but not parsed yet
+        std::string out;  // bytes waiting to be written
+        size_t outOffset = 0;
+        bool closeAfterWrite = false;
+        bool wantWrite = false;
+    };
+
+    static constexpr size_t maxRequestSize = 1 << 20;
+
+    int port;
+    int threadCount;
+    HttpHandler handler;
+    std::atomic<bool> running;
+    std::vector<std::thread> loops;
+    std::vector<int> listeners; // opened by listen(), one per event loop
+
+    static const char* statusText(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 409: return "Conflict";
+            case 413: return "Payload Too Large";
+            case 422: return "Unprocessable Entity";
+            case 429: return "Too Many Requests";
+            case 501: return "Not Implemented";
+            case 503: return "Service Unavailable";
+            default: return status < 500 ? "Error" : "Internal Server Error";
+        }
+    }
+
+    static bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    int openListener() {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    static void appendResponse(Connection& conn, const HttpResponse& res, bool keepAlive) {
+        std::string& out = conn.out;
+        out += "HTTP/1.1 ";
+        out += std::to_string(res.status);
+        out += ' ';
+        out += statusText(res.status);
+        out += "\r\nContent-Type: ";
+        out += res.contentType;
+        out += "\r\nContent-Length: ";
+        out += std::to_string(res.body.size());
+        out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        out += res.body;
+        if (!keepAlive) conn.closeAfterWrite = true;
+    }
+
+    static void errorResponse(Connection& conn, int status) {
+        HttpResponse res;
+        res.status = status;
+        res.body = std::string("{\"error\":\"") + statusText(status) + "\"}";
+        appendResponse(conn, res, false);
+    }
+
+    // Parses as many complete requests as are buffered and queues their responses.
+    // Returns false if the connection should be dropped without a reply.
+    bool processInput(Connection& conn) {
+        while (!conn.closeAfterWrite) {
+            size_t headerEnd = conn.in.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) {
+                if (conn.in.size() > maxRequestSize) errorResponse(conn, 413);
+                return true;
+            }
+
+            HttpRequest req;
+            size_t lineEnd = conn.in.find("\r\n");
+            std::string requestLine = conn.in.substr(0, lineEnd);
+            size_t sp1 = requestLine.find(' ');
+            size_t sp2 = requestLine.rfind(' ');
+            if (sp1 == std::string::npos || sp2 == sp1) {
+                errorResponse(conn, 400);
+                return true;
+            }
+            req.method = requestLine.substr(0, sp1);
+            std::string target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+            std::string version = requestLine.substr(sp2 + 1);
+            size_t q = target.find('?');
+            req.path = target.substr(0, q);
+            if (q != std::string::npos) req.query = target.substr(q + 1);
+
+            size_t pos = lineEnd + 2;
+            while (pos < headerEnd) {
+                size_t end = conn.in.find("\r\n", pos);
+                size_t colon = conn.in.find(':', pos);
+                if (colon != std::string::npos && colon < end) {
+                    std::string name = conn.in.substr(pos, colon - pos);
+                    for (auto& c : name) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                    size_t valueStart = colon + 1;
+                    while (valueStart < end && conn.in[valueStart] == ' ') valueStart++;
+                    req.headers.emplace_back(name, conn.in.substr(valueStart, end - valueStart));
+                }
+                pos = end + 2;
+            }
+
+            if (!req.header("transfer-encoding").empty()) {
+                errorResponse(conn, 501);
+                return true;
+            }
+            size_t contentLength = 0;
+            std::string lengthHeader = req.header("content-length");
+            if (!lengthHeader.empty()) contentLength = std::strtoul(lengthHeader.c_str(), nullptr, 10);
+            if (contentLength > maxRequestSize) {
+                errorResponse(conn, 413);
+                return true;
+            }
+            size_t total = headerEnd + 4 + contentLength;
+            if (conn.in.size() < total) return true; // wait for the rest of the body
+            req.body = conn.in.substr(headerEnd + 4, contentLength);
+            conn.in.erase(0, total);
+
+            std::string connectionHeader = req.header("connection");
+            for (auto& c : connectionHeader) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            bool keepAlive = version == "HTTP/1.1" ? connectionHeader != "close" : connectionHeader == "keep-alive";
+
+            HttpResponse res;
+            handler(req, res);
+            appendResponse(conn, res, keepAlive);
+        }
+        return true;
+    }
+
+    // Writes as much pending output as the socket takes. Returns false on error.
+    static bool flush(int fd, Connection& conn) {
+        while (conn.outOffset < conn.out.size()) {
+            ssize_t n = send(fd, conn.out.data() + conn.outOffset, conn.out.size() - conn.outOffset, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+                if (errno == EINTR) continue;
+                return false;
+            }
+            conn.outOffset += static_cast<size_t>(n);
+        }
+        conn.out.clear();
+        conn.outOffset = 0;
+        return true;
+    }
+
+    void eventLoop(int listenFd) {
+        int ep = epoll_create1(0);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(ep, EPOLL_CTL_ADD, listenFd, &ev);
+
+        std::unordered_map<int, Connection> connections;
+        std::vector<epoll_event> events(256);
+        char buf[16384];
+
+        auto closeConnection = [&](int fd) {
+            epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            connections.erase(fd);
+        };
+
+        while (running) {
+            int n = epoll_wait(ep, events.data(), static_cast<int>(events.size()), 500);
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+
+                if (fd == listenFd) {
+                    while (true) {
+                        int client = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+                        if (client < 0) break;
+                        int one = 1;
+                        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                        epoll_event cev{};
+                        cev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+                        cev.data.fd = client;
+                        epoll_ctl(ep, EPOLL_CTL_ADD, client, &cev);
+                        connections[client];
+                    }
+                    continue;
+                }
+
+                auto it = connections.find(fd);
+                if (it == connections.end()) continue;
+                Connection& conn = it->second;
+                bool alive = !(events[i].events & EPOLLERR);
+
+                if (alive && (events[i].events & EPOLLIN)) {
+                    while (true) {
+                        ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                        if (r > 0) {
+                            conn.in.append(buf, static_cast<size_t>(r));
+                            continue;
+                        }
+                        if (r < 0 && errno == EINTR) continue;
+                        if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) alive = false;
+                        break;
+                    }
+                    if (!processInput(conn)) alive = false;
+                }
+
+                if (alive && !conn.out.empty()) alive = flush(fd, conn);
+                if (!alive || (conn.out.empty() && (conn.closeAfterWrite || (events[i].events & EPOLLRDHUP)))) {
+                    closeConnection(fd);
+                    continue;
+                }
+
+                // Only ask for EPOLLOUT while there is unsent output
+                bool wantWrite = !conn.out.empty();
+                if (wantWrite != conn.wantWrite) {
+                    conn.wantWrite = wantWrite;
+                    epoll_event mev{};
+                    mev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (wantWrite ? EPOLLOUT : 0u);
+                    mev.data.fd = fd;
+                    epoll_ctl(ep, EPOLL_CTL_MOD, fd, &mev);
+                }
+            }
+        }
+
+        for (auto& entry : connections) close(entry.first);
+        close(listenFd);
+        close(ep);
+    }
+
+public:
+    // threads == 0 means one event loop per available core
+    HttpServer(int port, HttpHandler handler, int threads = 0)
+        : port(port), threadCount(threads), handler(std::move(handler)), running(false) {
+        if (threadCount <= 0) threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) threadCount = 1;
+    }
+
+    ~HttpServer() {
+        stop();
+        for (int l : listeners) close(l); // listen() without loop()
+    }
+
+    // Opens the listening sockets. Returns false (with errno set) if the
+    // port could not be bound.
+    bool listen() {
+        for (int i = 0; i < threadCount; i++) {
+            int fd = openListener();
+            if (fd < 0) {
+                int err = errno;
+                for (int l : listeners) close(l);
+                listeners.clear();
+                errno = err;
+                return false;
+            }
+            listeners.push_back(fd);
+        }
+        return true;
+    }
+
+    // Serves on the sockets listen() opened until stop() is called
+    void loop() {
+        running = true;
+        for (int i = 1; i < threadCount; i++) {
+            loops.emplace_back(&HttpServer::eventLoop, this, listeners[i]);
+        }
+        eventLoop(listeners[0]);
+        for (auto& t : loops) t.join();
+        loops.clear();
+        listeners.clear(); // the event loops closed them
+    }
+
+    // listen() then loop(); returns false if the port could not be bound
+    bool run() {
+        if (!listen()) return false;
+        loop();
+        return true;
+    }
+
+    void stop() {
+        running = false;
+    }
+
+    int threads() const {
+        return threadCount;
+    }
+};
+
+#endif // __linux__
+
+#endif
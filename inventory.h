@@ -0,0 +1,154 @@
+// inventory.h
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+// Blood unit stock, first-expired-first-out.
+// Units are kept in one 4-ary min-heap per (blood type, component) ordered by
+// expiry day, so receiving and issuing a unit are O(log n) and the unit issued
+// is always the one closest to expiring. Running counters per heap make stock
+// checks O(1); expire() drops units that ran out from the top of each heap.
+
+#include <string>
+#include <vector>
+#include "containers.h"
+
+enum Component {
+    WHOLE_BLOOD,
+    RED_CELLS,
+    PLATELETS,
+    PLASMA,
+    COMPONENT_COUNT
+};
+
+const int BLOOD_TYPE_COUNT = 8;
+
+struct BloodUnit {
+    int unitId;
+    int donorId;    // -1 if not from a registered donor
+    int bloodType;  // index into Inventory::typeName
+    Component component;
+    int collectedDay;
+    int expiryDay;  // last day the unit may be used
+};
+
+class Inventory {
+private:
+    struct Earlier {
+        bool operator()(const BloodUnit& a, const BloodUnit& b) const {
+            return a.expiryDay != b.expiryDay ? a.expiryDay < b.expiryDay : a.unitId < b.unitId;
+        }
+    };
+
+    using UnitHeap = DaryHeap<BloodUnit, Earlier>;
+
+    UnitHeap heaps[BLOOD_TYPE_COUNT][COMPONENT_COUNT];
+    int counts[BLOOD_TYPE_COUNT][COMPONENT_COUNT] = {};
+    int nextUnitId = 1;
+    int expiredTotal = 0;
+    int issuedTotal = 0;
+
+    int expireOne(int type, int component, int today) {
+        UnitHeap& heap = heaps[type][component];
+        int dropped = 0;
+        while (!heap.empty() && heap.top().expiryDay < today) {
+            heap.pop();
+            counts[type][component]--;
+            dropped++;
+        }
+        expiredTotal += dropped;
+        return dropped;
+    }
+
+public:
+    // Index of a blood type ("A+", "O-", ...) or -1 if it isn't a full ABO/Rh type
+    static int typeIndex(const std::string& bloodType) {
+        for (int i = 0; i < BLOOD_TYPE_COUNT; i++) {
+            if (bloodType == typeName(i)) return i;
+        }
+        return -1;
+    }
+
+    static const char* typeName(int type) {
+        static const char* names[BLOOD_TYPE_COUNT] = {"A+", "A-", "B+", "B-", "AB+", "AB-", "O+", "O-"};
+        return names[type];
+    }
+
+    static const char* componentName(int component) {
+        static const char* names[COMPONENT_COUNT] = {"Whole blood", "Red cells", "Platelets", "Plasma"};
+        return names[component];
+    }
+
+    // Storage life in days
+    static int shelfLife(int component) {
+        static const int days[COMPONENT_COUNT] = {35, 42, 5, 365};
+        return days[component];
+    }
+
+    // Adds a collected unit and returns its id
+    int receive(int bloodType, Component component, int collectedDay, int donorId = -1) {
+        BloodUnit unit{nextUnitId++, donorId, bloodType, component, collectedDay,
+                       collectedDay + shelfLife(component) - 1};
+        heaps[bloodType][component].push(unit);
+        counts[bloodType][component]++;
+        return unit.unitId;
+    }
+
+    // Issues up to count usable units, soonest expiry first
+    std::vector<BloodUnit> issue(int bloodType, Component component, int count, int today) {
+        expireOne(bloodType, component, today);
+        std::vector<BloodUnit> out;
+        UnitHeap& heap = heaps[bloodType][component];
+        while (count-- > 0 && !heap.empty()) {
+            out.push_back(heap.pop());
+            counts[bloodType][component]--;
+        }
+        issuedTotal += static_cast<int>(out.size());
+        return out;
+    }
+
+    // Drops every unit that expired before today. Returns how many.
+    int expire(int today) {
+        int dropped = 0;
+        for (int t = 0; t < BLOOD_TYPE_COUNT; t++) {
+            for (int c = 0; c < COMPONENT_COUNT; c++) dropped += expireOne(t, c, today);
+        }
+        return dropped;
+    }
+
+    // Units on hand (call expire() first for an up-to-date figure)
+    int stock(int bloodType, int component) const {
+        return counts[bloodType][component];
+    }
+
+    int stockOfType(int bloodType) const {
+        int total = 0;
+        for (int c = 0; c < COMPONENT_COUNT; c++) total += counts[bloodType][c];
+        return total;
+    }
+
+    // Usable units of a type counted unit by unit, without expiring anything
+    // (a slow cross-check of the running counters)
+    int countUsable(int bloodType, int today) const {
+        int total = 0;
+        for (int c = 0; c < COMPONENT_COUNT; c++) {
+            for (const BloodUnit& u : heaps[bloodType][c]) total += u.expiryDay >= today;
+        }
+        return total;
+    }
+
+    // Expiry day of the next unit to be issued, or -1 if out of stock
+    int nextExpiry(int bloodType, int component) const {
+        const UnitHeap& heap = heaps[bloodType][component];
+        return heap.empty() ? -1 : heap.top().expiryDay;
+    }
+
+    int expiredCount() const {
+        return expiredTotal;
+    }
+
+    int issuedCount() const {
+        return issuedTotal;
+    }
+};
+
+#endif
@@ -0,0 +1,183 @@
+// json.h
+#ifndef JSON_H
+#define JSON_H
+
+// Just enough JSON for the server mode: flat request objects in,
+// objects and arrays of objects out.
+
+#include <map>
+#include <string>
+#include <cstdio>
+#include <cctype>
+
+// Escapes a string for use inside a JSON string literal
+inline void jsonEscapeTo(std::string& out, const std::string& s) {
+    for (char ch : s) {
+        switch (ch) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                    out += buf;
+                } else {
+                    out += ch;
+                }
+        }
+    }
+}
+
+// Builds one JSON object: JsonObject().add("a", "x").add("n", 3).str()
+class JsonObject {
+private:
+    std::string out;
+
+    void key(const std::string& name) {
+        out += out.size() > 1 ? ",\"" : "\"";
+        jsonEscapeTo(out, name);
+        out += "\":";
+    }
+
+public:
+    JsonObject() : out("{") {}
+
+    JsonObject& add(const std::string& name, const std::string& value) {
+        key(name);
+        out += '"';
+        jsonEscapeTo(out, value);
+        out += '"';
+        return *this;
+    }
+
+    JsonObject& add(const std::string& name, const char* value) {
+        return add(name, std::string(value));
+    }
+
+    JsonObject& add(const std::string& name, long long value) {
+        key(name);
+        out += std::to_string(value);
+        return *this;
+    }
+
+    JsonObject& add(const std::string& name, int value) {
+        return add(name, static_cast<long long>(value));
+    }
+
+    JsonObject& add(const std::string& name, bool value) {
+        key(name);
+        out += value ? "true" : "false";
+        return *this;
+    }
+
+    JsonObject& add(const std::string& name, double value) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.3f", value);
+        key(name);
+        out += buf;
+        return *this;
+    }
+
+    // Adds an already-encoded JSON value (object, array, ...)
+    JsonObject& addRaw(const std::string& name, const std::string& json) {
+        key(name);
+        out += json;
+        return *this;
+    }
+
+    std::string str() const {
+        return out + "}";
+    }
+};
+
+// Parses a flat JSON object whose values are strings, numbers, booleans or null.
+// Every value is returned as a string. Returns false on malformed input.
+inline bool parseJsonObject(const std::string& text, std::map<std::string, std::string>& out) {
+    size_t i = 0;
+    auto skipSpace = [&]() {
+        while (i < text.size() && (text[i] == ' ' || text[i] == '\n' || text[i] == '\r' || text[i] == '\t')) i++;
+    };
+    auto parseString = [&](std::string& s) {
+        if (i >= text.size() || text[i] != '"') return false;
+        i++;
+        while (i < text.size() && text[i] != '"') {
+            char ch = text[i++];
+            if (ch != '\\') {
+                s += ch;
+                continue;
+            }
+            if (i >= text.size()) return false;
+            char esc = text[i++];
+            switch (esc) {
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'u': {
+                    if (i + 4 > text.size()) return false;
+                    for (size_t k = i; k < i + 4; k++) {
+                        if (!isxdigit(static_cast<unsigned char>(text[k]))) return false;
+                    }
+                    unsigned code = static_cast<unsigned>(std::stoul(text.substr(i, 4), nullptr, 16));
+                    i += 4;
+                    // Encode the code point as UTF-8 (surrogate pairs are not combined)
+                    if (code < 0x80) {
+                        s += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        s += static_cast<char>(0xC0 | (code >> 6));
+                        s += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        s += static_cast<char>(0xE0 | (code >> 12));
+                        s += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        s += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: s += esc;
+            }
+        }
+        if (i >= text.size()) return false;
+        i++; // closing quote
+        return true;
+    };
+
+    skipSpace();
+    if (i >= text.size() || text[i] != '{') return false;
+    i++;
+    skipSpace();
+    if (i < text.size() && text[i] == '}') return true;
+
+    while (i < text.size()) {
+        std::string name, value;
+        skipSpace();
+        if (!parseString(name)) return false;
+        skipSpace();
+        if (i >= text.size() || text[i] != ':') return false;
+        i++;
+        skipSpace();
+        if (i < text.size() && text[i] == '"') {
+            if (!parseString(value)) return false;
+        } else {
+            size_t start = i;
+            while (i < text.size() && text[i] != ',' && text[i] != '}' && !isspace(static_cast<unsigned char>(text[i]))) i++;
+            value = text.substr(start, i - start);
+            if (value.empty()) return false;
+            if (value == "null") value.clear();
+        }
+        out[name] = value;
+        skipSpace();
+        if (i < text.size() && text[i] == ',') {
+            i++;
+            continue;
+        }
+        if (i < text.size() && text[i] == '}') return true;
+        return false;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,217 @@
+// loadgen.h
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+// Seeded workload generator and replay harness.
+// Workload::generate() turns a seed and a weighted mix of operation kinds
+// into a fixed trace of events (kind, actor, arg): the same seed always gives
+// the same trace, and a trace saved to a file replays exactly. Kinds marked
+// createsActor (registering, enqueueing) introduce a new actor; the others
+// pick an existing one, skewed towards the earliest so a few actors are hot.
+// What an event does is up to the driver callback the program passes in.
+//
+// runWorkload() plays a trace on `threads` threads. An actor's events always
+// run on the same thread, in trace order, so a login never overtakes its
+// registration. With a rate the load is open-loop: event i is due at
+// start + i / rate, and latency counts from when it was due, so a slow call
+// also shows up in the latency of the calls queued behind it. Without a rate
+// every thread runs flat out and latency is the call alone.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "metrics.h"
+
+struct LoadKind {
+    std::string name;
+    int weight;
+    bool createsActor;
+};
+
+struct LoadEvent {
+    int kind;
+    uint32_t actor;
+    uint32_t arg; // random value for the driver (a date offset, a priority, ...)
+};
+
+struct LoadConfig {
+    double rate = 0; // events per second over all threads; 0 = as fast as possible
+    int threads = 1;
+};
+
+class Workload {
+public:
+    std::vector<LoadKind> kinds;
+    std::vector<LoadEvent> events;
+    uint32_t actors = 0; // actors created by the trace
+
+    static Workload generate(const std::vector<LoadKind>& kinds, size_t count, uint64_t seed) {
+        Workload w;
+        w.kinds = kinds;
+        std::mt19937_64 rng(seed);
+        int totalWeight = 0, firstCreating = -1;
+        for (size_t k = 0; k < kinds.size(); k++) {
+            totalWeight += kinds[k].weight;
+            if (kinds[k].createsActor && firstCreating < 0) firstCreating = static_cast<int>(k);
+        }
+        w.events.reserve(count);
+        for (size_t i = 0; i < count && totalWeight > 0; i++) {
+            int pick = static_cast<int>(rng() % static_cast<uint64_t>(totalWeight));
+            int kind = 0;
+            while (pick >= kinds[kind].weight) pick -= kinds[kind++].weight;
+            // Nobody to act on yet: start with an actor instead
+            if (!kinds[kind].createsActor && w.actors == 0 && firstCreating >= 0) kind = firstCreating;
+
+            uint32_t actor;
+            if (kinds[kind].createsActor) {
+                actor = w.actors++;
+            } else {
+                // u^3 puts about half the picks on the first eighth of the actors
+                double u = std::uniform_real_distribution<double>(0, 1)(rng);
+                actor = static_cast<uint32_t>(u * u * u * std::max<uint32_t>(w.actors, 1));
+            }
+            w.events.push_back({kind, actor, static_cast<uint32_t>(rng())});
+        }
+        return w;
+    }
+
+    // One "kind actor arg" line per event
+    bool save(const std::string& path) const {
+        std::ofstream out(path);
+        out << "# loadgen trace v1, " << events.size() << " events\n";
+        for (const LoadEvent& e : events) out << kinds[e.kind].name << ' ' << e.actor << ' ' << e.arg << '\n';
+        return static_cast<bool>(out.flush());
+    }
+
+    // Reads a saved trace; false if the file is missing or names a kind not in `kinds`
+    static bool load(const std::string& path, const std::vector<LoadKind>& kinds, Workload& w) {
+        std::ifstream in(path);
+        if (!in) return false;
+        w.kinds = kinds;
+        w.events.clear();
+        w.actors = 0;
+        std::string line, name;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            LoadEvent e{-1, 0, 0};
+            if (!(fields >> name >> e.actor >> e.arg)) return false;
+            for (size_t k = 0; k < kinds.size(); k++) {
+                if (kinds[k].name == name) e.kind = static_cast<int>(k);
+            }
+            if (e.kind < 0) return false;
+            w.actors = std::max(w.actors, e.actor + 1);
+            w.events.push_back(e);
+        }
+        return true;
+    }
+};
+
+struct LoadKindReport {
+    std::string name;
+    uint64_t count = 0;
+    uint64_t failures = 0;
+    uint64_t maxNs = 0;
+    std::vector<uint64_t> histogram = std::vector<uint64_t>(Metrics::buckets);
+
+    // Latency at quantile q in seconds, to within a bucket (about 12%)
+    double quantile(double q) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1, seen = 0;
+        for (int b = 0; b < Metrics::buckets; b++) {
+            seen += histogram[b];
+            if (seen >= rank) return std::min(Metrics::bucketValue(b), static_cast<double>(maxNs)) / 1e9;
+        }
+        return static_cast<double>(maxNs) / 1e9;
+    }
+
+    void merge(const LoadKindReport& other) {
+        count += other.count;
+        failures += other.failures;
+        maxNs = std::max(maxNs, other.maxNs);
+        for (int b = 0; b < Metrics::buckets; b++) histogram[b] += other.histogram[b];
+    }
+};
+
+struct LoadReport {
+    double seconds = 0;
+    std::vector<LoadKindReport> kinds;
+    LoadKindReport total;
+};
+
+// Runs every event through op(event, thread); op returns false on failure
+inline LoadReport runWorkload(const Workload& w, const LoadConfig& config,
+                              const std::function<bool(const LoadEvent&, int)>& op) {
+    using Clock = std::chrono::steady_clock;
+    int threads = std::max(config.threads, 1);
+    std::vector<std::vector<LoadKindReport>> perThread(threads, std::vector<LoadKindReport>(w.kinds.size()));
+
+    Clock::time_point start = Clock::now();
+    auto worker = [&](int t) {
+        std::vector<LoadKindReport>& mine = perThread[t];
+        for (size_t i = 0; i < w.events.size(); i++) {
+            const LoadEvent& e = w.events[i];
+            if (static_cast<int>(e.actor % static_cast<uint32_t>(threads)) != t) continue;
+            Clock::time_point due = Clock::now();
+            if (config.rate > 0) {
+                due = start + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(static_cast<double>(i) / config.rate));
+                std::this_thread::sleep_until(due);
+            }
+            bool ok = op(e, t);
+            uint64_t ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count());
+            LoadKindReport& r = mine[e.kind];
+            r.count++;
+            r.failures += !ok;
+            r.maxNs = std::max(r.maxNs, ns);
+            r.histogram[Metrics::bucketOf(ns)]++;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool) th.join();
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.total.name = "total";
+    for (size_t k = 0; k < w.kinds.size(); k++) {
+        LoadKindReport r;
+        r.name = w.kinds[k].name;
+        for (int t = 0; t < threads; t++) r.merge(perThread[t][k]);
+        report.total.merge(r);
+        report.kinds.push_back(std::move(r));
+    }
+    return report;
+}
+
+// Throughput and latency quantiles per kind, in microseconds
+inline void printLoadReport(const LoadReport& report, std::ostream& out) {
+    out << std::fixed << std::setprecision(1);
+    out << report.total.count << " operations in " << report.seconds << " s ("
+        << static_cast<long long>(static_cast<double>(report.total.count) / report.seconds) << " ops/s)\n";
+    out << std::left << std::setw(12) << "operation" << std::right << std::setw(9) << "count" << std::setw(9)
+        << "failed" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us" << std::setw(10) << "p99 us"
+        << std::setw(10) << "p99.9 us" << std::setw(10) << "max us" << "\n";
+    auto row = [&out](const LoadKindReport& r) {
+        out << std::left << std::setw(12) << r.name << std::right << std::setw(9) << r.count << std::setw(9)
+            << r.failures;
+        for (double q : {0.5, 0.9, 0.99, 0.999}) out << std::setw(10) << r.quantile(q) * 1e6;
+        out << std::setw(10) << static_cast<double>(r.maxNs) / 1e3 << "\n";
+    };
+    for (const LoadKindReport& r : report.kinds) row(r);
+    row(report.total);
+    out << std::defaultfloat;
+}
+
+#endif
@@ -0,0 +1,216 @@
+// location_index.h
+#ifndef LOCATION_INDEX_H
+#define LOCATION_INDEX_H
+
+// Donors by place: region > city > worda > kebele.
+// Every location is an interned node in a tree; a donor is added to each node
+// on their path, in a bitset per blood type, so a node's sets hold everyone
+// living anywhere under it and per-area counts by blood type are O(1).
+//
+// Donor ids only grow, so each bitset stores just its non-zero 64-bit words
+// with their word index, appended in order. Walking a set costs time in its
+// members, not in the donor count, and widening from a kebele to its worda
+// and city walks the sibling areas only, so every donor is visited once.
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "containers.h"
+
+enum LocationLevel {
+    LEVEL_REGION,
+    LEVEL_CITY,
+    LEVEL_WORDA,
+    LEVEL_KEBELE,
+    LEVEL_COUNT
+};
+
+class LocationIndex {
+public:
+    static constexpr int typeCount = 9; // 8 ABO/Rh types + unknown
+    static constexpr unsigned allTypes = (1u << typeCount) - 1;
+
+    struct Nearby {
+        int donorId;
+        int widened; // 0 = same area, 1 = rest of the parent area, ...
+    };
+
+private:
+    // Sorted sparse bitset of donor ids, added in increasing order
+    struct DonorBits {
+        std::vector<uint32_t> wordIndex;
+        std::vector<uint64_t> words;
+        int count = 0;
+
+        void add(int id) {
+            uint32_t w = static_cast<uint32_t>(id) >> 6;
+            if (wordIndex.empty() || wordIndex.back() != w) {
+                wordIndex.push_back(w);
+                words.push_back(0);
+            }
+            uint64_t bit = uint64_t(1) << (id & 63);
+            if (!(words.back() & bit)) {
+                words.back() |= bit;
+                count++;
+            }
+        }
+
+        // Calls fn(id) in increasing order until it returns false
+        template <typename Fn>
+        bool forEach(Fn fn) const {
+            for (size_t i = 0; i < words.size(); i++) {
+                uint64_t bits = words[i];
+                while (bits) {
+                    int id = static_cast<int>((wordIndex[i] << 6) | __builtin_ctzll(bits));
+                    if (!fn(id)) return false;
+                    bits &= bits - 1;
+                }
+            }
+            return true;
+        }
+    };
+
+    struct Node {
+        std::string name;
+        int parent;
+        int level;
+        std::vector<int> children;
+        DonorBits byType[typeCount];
+        int total = 0;
+    };
+
+    std::vector<Node> nodes;
+    FlatHashMap<std::string, int> lookup; // parent id + '/' + folded name -> node
+    std::vector<int> roots;               // regions
+
+    static std::string fold(const std::string& name) {
+        std::string out;
+        for (char ch : name) {
+            if (ch == ' ' || ch == '\t') {
+                if (!out.empty() && out.back() != ' ') out += ' ';
+            } else {
+                out += static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+            }
+        }
+        if (!out.empty() && out.back() == ' ') out.pop_back();
+        return out;
+    }
+
+    static std::string key(int parent, const std::string& name) {
+        return std::to_string(parent) + '/' + fold(name);
+    }
+
+    int child(int parent, const std::string& name) const {
+        const int* id = lookup.find(key(parent, name));
+        return id ? *id : -1;
+    }
+
+    int intern(int parent, const std::string& name, int level) {
+        std::string k = key(parent, name);
+        if (const int* id = lookup.find(k)) return *id;
+        int id = static_cast<int>(nodes.size());
+        nodes.push_back(Node{name, parent, level, {}, {}, 0});
+        lookup.insert(k, id);
+        if (parent < 0) roots.push_back(id);
+        else nodes[parent].children.push_back(id);
+        return id;
+    }
+
+    // Adds the node's donors of the wanted types, skipping the subtree `except`
+    void collect(int node, int except, unsigned typeMask, int widened, size_t wanted,
+                 std::vector<Nearby>& out) const {
+        const Node& n = nodes[node];
+        if (except >= 0) {
+            for (int c : n.children) {
+                if (c != except) collect(c, -1, typeMask, widened, wanted, out);
+                if (out.size() >= wanted) return;
+            }
+            return;
+        }
+        for (int t = 0; t < typeCount && out.size() < wanted; t++) {
+            if (!(typeMask & (1u << t))) continue;
+            n.byType[t].forEach([&](int id) {
+                out.push_back({id, widened});
+                return out.size() < wanted;
+            });
+        }
+    }
+
+public:
+    // Adds a donor under region > city > worda > kebele. bloodType is an
+    // Inventory type index, or -1 if unknown. Ids must grow.
+    void add(int donorId, int bloodType, const std::string& region, const std::string& city,
+             const std::string& worda, const std::string& kebele) {
+        int type = bloodType >= 0 && bloodType < typeCount - 1 ? bloodType : typeCount - 1;
+        const std::string* path[LEVEL_COUNT] = {&region, &city, &worda, &kebele};
+        int node = -1;
+        for (int level = 0; level < LEVEL_COUNT; level++) {
+            node = intern(node, *path[level], level);
+            nodes[node].byType[type].add(donorId);
+            nodes[node].total++;
+        }
+    }
+
+    // Node for a place, as deep as the names given (empty names stop the
+    // path: find("Amhara", "Bahir Dar") is the city). -1 if unknown.
+    int find(const std::string& region, const std::string& city = "", const std::string& worda = "",
+             const std::string& kebele = "") const {
+        const std::string* path[LEVEL_COUNT] = {&region, &city, &worda, &kebele};
+        int node = -1;
+        for (int level = 0; level < LEVEL_COUNT && !path[level]->empty(); level++) {
+            node = child(node, *path[level]);
+            if (node < 0) return -1;
+        }
+        return node;
+    }
+
+    // Up to `wanted` donors of the types in typeMask (bit = type index),
+    // nearest first: the area itself, then the rest of its parent area, and
+    // so on up to the region (never across regions).
+    std::vector<Nearby> nearest(int node, size_t wanted, unsigned typeMask = allTypes) const {
+        std::vector<Nearby> out;
+        int widened = 0;
+        int except = -1;
+        while (node >= 0 && out.size() < wanted) {
+            collect(node, except, typeMask, widened, wanted, out);
+            except = node;
+            node = nodes[node].parent;
+            widened++;
+        }
+        return out;
+    }
+
+    // Donors under the node with the given type index (-1 = unknown type)
+    int count(int node, int bloodType) const {
+        int type = bloodType >= 0 && bloodType < typeCount - 1 ? bloodType : typeCount - 1;
+        return nodes[node].byType[type].count;
+    }
+
+    int total(int node) const {
+        return nodes[node].total;
+    }
+
+    const std::string& name(int node) const {
+        return nodes[node].name;
+    }
+
+    int parent(int node) const {
+        return nodes[node].parent;
+    }
+
+    int level(int node) const {
+        return nodes[node].level;
+    }
+
+    // Sub-areas of a node, or the regions for -1
+    const std::vector<int>& children(int node) const {
+        return node < 0 ? roots : nodes[node].children;
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+};
+
+#endif
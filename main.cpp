@@ -1,10 +1,25 @@
 // main.cpp
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 #include <libpq-fe.h>
+#include "donor_repository.h"
 #include "main.h"
+#include "pg_async.h"
+
+// Overridden by the PG_CONNINFO environment variable
+const char* connInfo() {
+    const char* env = std::getenv("PG_CONNINFO");
+    return env ? env : "host=localhost port=5432 dbname=blood_bank user=postgres password=kaluLILUYA#1";
+}
 
 void connectAndQuery() {
-    PGconn* conn = PQconnectdb("host=localhost port=5432 dbname=blood_bank user=postgres password=kaluLILUYA#1");
+    PGconn* conn = PQconnectdb(connInfo());
 
     if (PQstatus(conn) != CONNECTION_OK) {
         std::cerr << "Connection to database failed: " << PQerrorMessage(conn) << std::endl;
@@ -27,7 +42,201 @@ void connectAndQuery() {
     PQfinish(conn);
 }
 
-int main() {
+// Statement both benchmark paths run, one round trip each
+const char* benchSql = "SELECT $1::int4 * 2";
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One connection, PQexecPrepared after PQexecPrepared. Returns seconds, or -1.
+double benchSync(int queries) {
+    PGconn* conn = PQconnectdb(connInfo());
+    if (PQstatus(conn) != CONNECTION_OK) {
+        std::cerr << "Connection to database failed: " << PQerrorMessage(conn) << std::endl;
+        PQfinish(conn);
+        return -1;
+    }
+    PGresult* res = PQprepare(conn, "bench", benchSql, 1, nullptr);
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries && ok; i++) {
+        std::string param = std::to_string(i);
+        const char* values[1] = {param.c_str()};
+        res = PQexecPrepared(conn, "bench", 1, values, nullptr, nullptr, 0);
+        ok = PQresultStatus(res) == PGRES_TUPLES_OK && std::atoi(PQgetvalue(res, 0, 0)) == i * 2;
+        PQclear(res);
+    }
+    double seconds = secondsSince(start);
+    if (!ok) std::cerr << "Query failed: " << PQerrorMessage(conn) << std::endl;
+    PQfinish(conn);
+    return ok ? seconds : -1;
+}
+
+// Each worker coroutine runs its share of the queries through the pool
+PgTask<void> benchWorker(PgPool& pool, int first, int count, int& failures) {
+    for (int i = first; i < first + count; i++) {
+        std::vector<std::string> params{std::to_string(i)};
+        PgResult r = co_await pool.execPrepared("bench", std::move(params));
+        if (!r || PQresultStatus(r.get()) != PGRES_TUPLES_OK || std::atoi(PQgetvalue(r.get(), 0, 0)) != i * 2) {
+            failures++;
+        }
+    }
+}
+
+PgTask<void> setupPool(PgPool& pool, int connections, bool& ready) {
+    ready = co_await pool.connect(connInfo(), connections);
+    if (ready) ready = co_await pool.prepare("bench", benchSql, 1);
+}
+
+// Many queries in flight from one thread over a pool. Returns seconds, or -1.
+double benchAsync(int queries, int connections) {
+    PgLoop loop;
+    PgPool pool(loop);
+    bool ready = false;
+    loop.spawn(setupPool(pool, connections, ready));
+    if (!loop.run() || !ready) {
+        std::cerr << "Connection to database failed: " << pool.errorMessage() << std::endl;
+        return -1;
+    }
+
+    // More concurrent requests than connections, as behind a busy front end
+    int workers = connections * 4;
+    int failures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int w = 0; w < workers; w++) {
+        int first = static_cast<int>(static_cast<long long>(queries) * w / workers);
+        int next = static_cast<int>(static_cast<long long>(queries) * (w + 1) / workers);
+        loop.spawn(benchWorker(pool, first, next - first, failures));
+    }
+    bool ok = loop.run();
+    double seconds = secondsSince(start);
+    if (!ok || failures > 0) {
+        std::cerr << "Query failed (" << failures << " failures): " << pool.errorMessage() << std::endl;
+        return -1;
+    }
+    return seconds;
+}
+
+void printRate(const char* label, int queries, double seconds) {
+    std::cout << label << queries << " queries in " << seconds << " s ("
+              << static_cast<long long>(queries / seconds) << " queries/s)" << std::endl;
+}
+
+// Seeded Zipf(0.99) ranks: a few donors log in all the time, most rarely
+class ZipfPicker {
+private:
+    std::vector<double> cdf;
+    std::mt19937_64 rng;
+
+public:
+    ZipfPicker(int n, uint64_t seed) : cdf(n), rng(seed) {
+        double total = 0;
+        for (int i = 0; i < n; i++) cdf[i] = total += 1.0 / std::pow(i + 1, 0.99);
+        for (double& c : cdf) c /= total;
+    }
+
+    int next() {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    }
+};
+
+void printCacheStats(const char* label, const CacheStats& s) {
+    std::cout << label << ": hit rate " << s.hitRate() * 100 << "%, " << s.hits << " hits, " << s.loads
+              << " database loads (avg " << s.averageLoadMicros() << " us), " << s.evictions << " evictions, "
+              << s.invalidations << " invalidations" << std::endl;
+}
+
+// Logins (80%), appointment views (15%) and bookings (5%) for Zipf-popular
+// donors through the read-through cache
+int benchCache(int lookups, int donorCount, int cacheSize) {
+    PGconn* conn = PQconnectdb(connInfo());
+    if (PQstatus(conn) != CONNECTION_OK) {
+        std::cerr << "Connection to database failed: " << PQerrorMessage(conn) << std::endl;
+        PQfinish(conn);
+        return 1;
+    }
+    PgDonorRepository store(conn);
+    if (!store.prepare()) {
+        std::cerr << "Preparing statements failed: " << store.errorMessage() << std::endl;
+        PQfinish(conn);
+        return 1;
+    }
+    CachedDonorRepository cache(store, cacheSize, cacheSize);
+
+    for (int i = 0; i < donorCount; i++) {
+        DonorRecord d;
+        d.username = "benchdonor" + std::to_string(i);
+        d.password = "secret" + std::to_string(i);
+        d.firstName = "Bench";
+        d.lastName = "Donor";
+        d.bloodType = "O+";
+        cache.registerDonor(d); // false if it is left over from an earlier run
+    }
+
+    ZipfPicker pick(donorCount, 42);
+    std::mt19937 rng(7);
+    uint64_t queriesBefore = store.queryCount();
+    int failures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        int n = pick.next();
+        std::string username = "benchdonor" + std::to_string(n);
+        int kind = static_cast<int>(rng() % 100);
+        if (kind < 80) {
+            failures += cache.login(username, "secret" + std::to_string(n)) == nullptr;
+        } else if (kind < 95) {
+            failures += cache.appointmentsFor(username) == nullptr;
+        } else {
+            failures += !cache.bookAppointment(username, {"2030-01-01", "09:00", "bench"});
+        }
+    }
+    double seconds = secondsSince(start);
+    uint64_t queries = store.queryCount() - queriesBefore;
+
+    printRate("Cached requests: ", lookups, seconds);
+    std::cout << "Database round trips: " << queries << " (" << 100.0 * static_cast<double>(queries) / lookups
+              << "% of requests), failures: " << failures << std::endl;
+    printCacheStats("Donor cache", cache.donorStats());
+    printCacheStats("Appointment cache", cache.appointmentStats());
+#ifndef DISABLE_METRICS
+    std::cout << Metrics::prometheus();
+#endif
+    PQfinish(conn);
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    // main --cache-bench [requests] [donors] [cache entries]
+    if (argc > 1 && std::string(argv[1]) == "--cache-bench") {
+        int lookups = argc > 2 ? std::atoi(argv[2]) : 100000;
+        int donorCount = argc > 3 ? std::atoi(argv[3]) : 10000;
+        int cacheSize = argc > 4 ? std::atoi(argv[4]) : 1000;
+        if (lookups <= 0 || donorCount <= 0 || cacheSize <= 0) {
+            std::cerr << "Usage: main --cache-bench [requests] [donors] [cache entries]" << std::endl;
+            return 1;
+        }
+        return benchCache(lookups, donorCount, cacheSize);
+    }
+    // main --bench [queries] [connections]
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        int queries = argc > 2 ? std::atoi(argv[2]) : 10000;
+        int connections = argc > 3 ? std::atoi(argv[3]) : 8;
+        if (queries <= 0 || connections <= 0) {
+            std::cerr << "Usage: main --bench [queries] [connections]" << std::endl;
+            return 1;
+        }
+        double sync = benchSync(queries);
+        if (sync < 0) return 1;
+        printRate("Sync (1 connection):   ", queries, sync);
+        double async = benchAsync(queries, connections);
+        if (async < 0) return 1;
+        printRate(("Async (" + std::to_string(connections) + " connections): ").c_str(), queries, async);
+        return 0;
+    }
     connectAndQuery();
     return 0;
 }
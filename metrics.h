@@ -0,0 +1,243 @@
+// metrics.h
+#ifndef METRICS_H
+#define METRICS_H
+
+// Low-overhead operation metrics with a Prometheus text dump.
+// TIME_OPERATION("name") at the top of a function counts every call and
+// records the latency of one call in sampleEvery (starting with the first)
+// into an HDR-style histogram: log-linear buckets, 8 per power of two, so
+// about 12% wide.
+// Counters and histograms live in per-thread blocks written without atomic
+// read-modify-write or locks; prometheus() sums the blocks when asked. When a
+// thread exits its block, counts included, is handed to the next new thread,
+// so there are only ever as many blocks as threads that were alive at once.
+// Gauges (list sizes and the like) are callbacks evaluated only on dump,
+// outside the registry lock, so a gauge may take the caller's own locks.
+//
+// Build with -DDISABLE_METRICS to compile every hook out.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Metrics {
+public:
+    static constexpr int maxOperations = 48;
+    static constexpr int buckets = 496; // values up to 2^63 ns
+    static constexpr uint32_t sampleEvery = 16; // power of two
+
+    struct ThreadBlock {
+        std::atomic<uint64_t> calls[maxOperations];
+        std::atomic<uint64_t> samples[maxOperations];
+        std::atomic<uint64_t> sumNs[maxOperations];
+        std::atomic<uint64_t> histogram[maxOperations][buckets];
+        uint32_t ticks[maxOperations]; // calls so far, to pick the sampled ones
+
+        ThreadBlock() {
+            for (int i = 0; i < maxOperations; i++) {
+                ticks[i] = 0;
+                calls[i].store(0, std::memory_order_relaxed);
+                samples[i].store(0, std::memory_order_relaxed);
+                sumNs[i].store(0, std::memory_order_relaxed);
+                for (auto& b : histogram[i]) b.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // Only this thread writes its block, so a plain load + store is enough
+    static void bump(std::atomic<uint64_t>& v, uint64_t by = 1) {
+        v.store(v.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static int bucketOf(uint64_t ns) {
+        if (ns < 8) return static_cast<int>(ns);
+        int e = 63 - __builtin_clzll(ns);
+        return (e - 2) * 8 + static_cast<int>((ns >> (e - 3)) & 7);
+    }
+
+    // Middle of a bucket's range, used for quantiles
+    static double bucketValue(int b) {
+        if (b < 8) return b;
+        int e = b / 8 + 2;
+        double low = static_cast<double>((8 + b % 8)) * static_cast<double>(uint64_t(1) << (e - 3));
+        return low + static_cast<double>(uint64_t(1) << (e - 3)) / 2;
+    }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static ThreadBlock* threadBlock() {
+        thread_local BlockOwner owner;
+        if (!owner.block) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            if (r.idle.empty()) {
+                owner.block = new ThreadBlock;
+                r.blocks.push_back(owner.block);
+            } else {
+                // A finished thread's block: its counts stay in the totals and this thread adds to them
+                owner.block = r.idle.back();
+                r.idle.pop_back();
+            }
+        }
+        return owner.block;
+    }
+
+    // Id for an operation name; the same name always gets the same id.
+    // Returns -1 once maxOperations names are taken.
+    static int registerOperation(const std::string& name) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        for (size_t i = 0; i < r.operations.size(); i++) {
+            if (r.operations[i] == name) return static_cast<int>(i);
+        }
+        if (static_cast<int>(r.operations.size()) >= maxOperations) return -1;
+        r.operations.push_back(name);
+        return static_cast<int>(r.operations.size()) - 1;
+    }
+
+    static void registerGauge(const std::string& name, const std::string& help, std::function<double()> read) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.gauges.push_back({name, help, std::move(read)});
+    }
+
+    // All metrics in the Prometheus text exposition format
+    static std::string prometheus() {
+        Registry& r = registry();
+        std::unique_lock<std::mutex> lock(r.mtx);
+        std::string out;
+        std::vector<uint64_t> hist(buckets);
+        std::vector<Gauge> gauges = r.gauges;
+        for (size_t op = 0; op < r.operations.size(); op++) {
+            uint64_t calls = 0, samples = 0, sumNs = 0;
+            std::fill(hist.begin(), hist.end(), 0);
+            for (ThreadBlock* b : r.blocks) {
+                calls += b->calls[op].load(std::memory_order_relaxed);
+                samples += b->samples[op].load(std::memory_order_relaxed);
+                sumNs += b->sumNs[op].load(std::memory_order_relaxed);
+                for (int i = 0; i < buckets; i++) hist[i] += b->histogram[op][i].load(std::memory_order_relaxed);
+            }
+            const std::string& name = r.operations[op];
+            out += "# TYPE " + name + "_calls_total counter\n";
+            out += name + "_calls_total " + std::to_string(calls) + "\n";
+            out += "# HELP " + name + "_seconds Latency of sampled calls (1 in " + std::to_string(sampleEvery) + ")\n";
+            out += "# TYPE " + name + "_seconds summary\n";
+            static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+            for (double q : quantiles) {
+                out += name + "_seconds{quantile=\"" + formatDouble(q) + "\"} " +
+                       formatDouble(quantile(hist, samples, q) / 1e9) + "\n";
+            }
+            out += name + "_seconds_sum " + formatDouble(sumNs / 1e9) + "\n";
+            out += name + "_seconds_count " + std::to_string(samples) + "\n";
+        }
+        // Gauges run without the lock: one that locks a store would otherwise
+        // deadlock against a thread holding that store while registering
+        lock.unlock();
+        for (const Gauge& g : gauges) {
+            out += "# HELP " + g.name + " " + g.help + "\n";
+            out += "# TYPE " + g.name + " gauge\n";
+            out += g.name + " " + formatDouble(g.read()) + "\n";
+        }
+        return out;
+    }
+
+private:
+    struct Gauge {
+        std::string name;
+        std::string help;
+        std::function<double()> read;
+    };
+
+    struct Registry {
+        std::mutex mtx;
+        std::vector<std::string> operations;
+        std::vector<ThreadBlock*> blocks; // every block, summed by prometheus()
+        std::vector<ThreadBlock*> idle;   // blocks of threads that have exited
+        std::vector<Gauge> gauges;
+    };
+
+    // Gives the thread's block back when the thread exits
+    struct BlockOwner {
+        ThreadBlock* block = nullptr;
+
+        ~BlockOwner() {
+            if (!block) return;
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            r.idle.push_back(block);
+            block = nullptr;
+        }
+    };
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    static double quantile(const std::vector<uint64_t>& hist, uint64_t total, double q) {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < buckets; i++) {
+            seen += hist[i];
+            if (seen >= rank) return bucketValue(i);
+        }
+        return bucketValue(buckets - 1);
+    }
+
+    static std::string formatDouble(double v) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.9g", v);
+        return buf;
+    }
+};
+
+// Counts a call and times one call in sampleEvery, until end of scope
+class ScopedTimer {
+private:
+    Metrics::ThreadBlock* block;
+    int id;
+    uint64_t start = 0;
+
+public:
+    explicit ScopedTimer(int id) : block(Metrics::threadBlock()), id(id) {
+        if (id < 0) return;
+        Metrics::bump(block->calls[id]);
+        // The first call and every sampleEvery-th after it are timed, per operation
+        if ((block->ticks[id]++ & (Metrics::sampleEvery - 1)) == 0) start = Metrics::nowNs();
+    }
+
+    ~ScopedTimer() {
+        if (start == 0) return;
+        uint64_t ns = Metrics::nowNs() - start;
+        Metrics::bump(block->samples[id]);
+        Metrics::bump(block->sumNs[id], ns);
+        Metrics::bump(block->histogram[id][Metrics::bucketOf(ns)]);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#define METRICS_CONCAT2(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT2(a, b)
+
+#ifdef DISABLE_METRICS
+#define TIME_OPERATION(name) ((void)0)
+#else
+#define TIME_OPERATION(name)                                                            \
+    static const int METRICS_CONCAT(metricId_, __LINE__) = Metrics::registerOperation(name); \
+    ScopedTimer METRICS_CONCAT(metricTimer_, __LINE__)(METRICS_CONCAT(metricId_, __LINE__))
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+// mvcc.h
+#ifndef MVCC_H
+#define MVCC_H
+
+// Multi-version row store for snapshot-isolated reads.
+// Every insert/update publishes a new immutable version of a row stamped
+// with the next commit number, linked to the version it replaces. A reader
+// takes a Snapshot, which pins the current commit number; get(row) walks
+// the row's chain to the newest version at or before it. Readers never take
+// a lock and never see a later write, so a long scan or sort works on a
+// consistent picture while writers carry on.
+//
+// Reclamation is epoch-based, with commit numbers as the epochs: each
+// active snapshot holds its commit number in a reader slot. When a row is
+// updated, versions older than the newest one every active snapshot can
+// already see are unreachable and are freed on the spot.
+//
+// Writers are serialized by an internal mutex. Rows are never removed;
+// store a "deleted" flag in T if needed.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+template <typename T>
+class VersionStore {
+private:
+    static constexpr size_t chunkBits = 10;
+    static constexpr size_t chunkSize = size_t(1) << chunkBits;
+    static constexpr size_t maxChunks = size_t(1) << 16; // 64M rows
+    static constexpr int maxReaders = 64;
+    static constexpr uint64_t reserved = UINT64_MAX; // slot claimed, commit not set yet
+
+    struct Version {
+        T value;
+        uint64_t commit;
+        std::atomic<Version*> older;
+    };
+
+    struct Chunk {
+        std::atomic<Version*> slots[chunkSize];
+    };
+
+    std::unique_ptr<std::atomic<Chunk*>[]> chunks;
+    std::atomic<size_t> rowCount{0};
+    std::atomic<uint64_t> commitCount{0};
+    mutable std::atomic<uint64_t> readers[maxReaders] = {}; // 0 = free, else snapshot commit + 1
+    std::mutex writeMutex;
+
+    std::atomic<Version*>& slot(size_t row) const {
+        return chunks[row >> chunkBits].load(std::memory_order_acquire)->slots[row & (chunkSize - 1)];
+    }
+
+    // Oldest commit any snapshot may still read
+    uint64_t oldestVisible() const {
+        uint64_t oldest = commitCount.load();
+        for (const auto& r : readers) {
+            uint64_t v = r.load();
+            if (v != 0 && v != reserved && v - 1 < oldest) oldest = v - 1;
+        }
+        return oldest;
+    }
+
+    static void freeChain(Version* v) {
+        while (v) {
+            Version* older = v->older.load(std::memory_order_relaxed);
+            delete v;
+            v = older;
+        }
+    }
+
+    // Drops the versions behind the newest one visible to every snapshot
+    void prune(Version* head) {
+        uint64_t oldest = oldestVisible();
+        Version* v = head;
+        while (v && v->commit > oldest) v = v->older.load(std::memory_order_relaxed);
+        if (v) freeChain(v->older.exchange(nullptr));
+    }
+
+    int acquireReader() const {
+        while (true) {
+            for (int i = 0; i < maxReaders; i++) {
+                uint64_t expected = 0;
+                if (readers[i].compare_exchange_strong(expected, reserved)) return i;
+            }
+            std::this_thread::yield(); // every slot busy, wait for a reader to finish
+        }
+    }
+
+public:
+    class Snapshot {
+    private:
+        const VersionStore* store = nullptr;
+        int reader = -1;
+        uint64_t commit = 0;
+        size_t rows = 0;
+
+        friend class VersionStore;
+
+    public:
+        Snapshot() {}
+
+        Snapshot(Snapshot&& other) noexcept
+            : store(other.store), reader(other.reader), commit(other.commit), rows(other.rows) {
+            other.reader = -1;
+        }
+
+        Snapshot& operator=(Snapshot&& other) noexcept {
+            if (this != &other) {
+                release();
+                store = other.store;
+                reader = other.reader;
+                commit = other.commit;
+                rows = other.rows;
+                other.reader = -1;
+            }
+            return *this;
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        ~Snapshot() {
+            release();
+        }
+
+        void release() {
+            if (reader < 0) return;
+            store->readers[reader].store(0);
+            reader = -1;
+        }
+
+        // Upper bound on rows; rows added after the snapshot read as nullptr
+        size_t size() const {
+            return rows;
+        }
+
+        uint64_t version() const {
+            return commit;
+        }
+
+        // The row as of the snapshot, or nullptr if it didn't exist yet
+        const T* get(size_t row) const {
+            if (row >= rows) return nullptr;
+            const Version* v = store->slot(row).load(std::memory_order_acquire);
+            while (v && v->commit > commit) v = v->older.load(std::memory_order_acquire);
+            return v ? &v->value : nullptr;
+        }
+    };
+
+    VersionStore() : chunks(new std::atomic<Chunk*>[maxChunks]) {
+        for (size_t i = 0; i < maxChunks; i++) chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~VersionStore() {
+        size_t rows = rowCount.load();
+        for (size_t r = 0; r < rows; r++) freeChain(slot(r).load());
+        for (size_t i = 0; i < maxChunks; i++) delete chunks[i].load();
+    }
+
+    VersionStore(const VersionStore&) = delete;
+    VersionStore& operator=(const VersionStore&) = delete;
+
+    // Appends a row and returns its index
+    size_t insert(T value) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        size_t row = rowCount.load(std::memory_order_relaxed);
+        if (row % chunkSize == 0) {
+            Chunk* chunk = new Chunk;
+            for (auto& s : chunk->slots) s.store(nullptr, std::memory_order_relaxed);
+            chunks[row >> chunkBits].store(chunk, std::memory_order_release);
+        }
+        Version* v = new Version{std::move(value), commitCount.load() + 1, {nullptr}};
+        slot(row).store(v, std::memory_order_release);
+        commitCount.fetch_add(1);
+        rowCount.store(row + 1, std::memory_order_release);
+        return row;
+    }
+
+    // Publishes a new version of an existing row
+    void update(size_t row, T value) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::atomic<Version*>& s = slot(row);
+        Version* v = new Version{std::move(value), commitCount.load() + 1, {s.load(std::memory_order_relaxed)}};
+        s.store(v, std::memory_order_release);
+        commitCount.fetch_add(1);
+        prune(v);
+    }
+
+    // Latest committed value (writer side; nullptr past the end)
+    const T* latest(size_t row) const {
+        if (row >= rowCount.load(std::memory_order_acquire)) return nullptr;
+        return &slot(row).load(std::memory_order_acquire)->value;
+    }
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        snap.store = this;
+        snap.reader = acquireReader();
+        std::atomic<uint64_t>& r = readers[snap.reader];
+        // Publish the commit we read before relying on it, and retry if a
+        // writer committed in between (it may have missed our slot)
+        uint64_t commit;
+        do {
+            commit = commitCount.load();
+            r.store(commit + 1);
+        } while (commitCount.load() != commit);
+        snap.commit = commit;
+        snap.rows = rowCount.load(std::memory_order_acquire);
+        return snap;
+    }
+
+    size_t size() const {
+        return rowCount.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,254 @@
+// notify.h
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+// Notification dispatch: SMS and email messages are scheduled in a time
+// index, moved to bounded per-channel queues when due, and handed to each
+// channel's sink in batches. Failed messages go to a retry queue with
+// exponential backoff and are dropped after maxAttempts. When a ready queue
+// is full the producer dispatches a round itself before queuing more
+// (caller-runs backpressure), so a burst can't grow memory without bound.
+// tick() does one round; start() runs it on a timer thread. Sinks are called
+// without the pipeline lock, so a slow gateway holds up only other
+// deliveries, not scheduling.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum Channel {
+    CHANNEL_SMS,
+    CHANNEL_EMAIL,
+    CHANNEL_COUNT
+};
+
+struct Notification {
+    Channel channel;
+    std::string recipient; // phone number or email address
+    std::string text;
+    int attempts = 0;
+};
+
+class NotificationSink {
+public:
+    virtual ~NotificationSink() {}
+
+    // Delivers a batch and returns the indexes of messages that failed
+    virtual std::vector<size_t> deliver(const std::vector<Notification>& batch) = 0;
+};
+
+// Appends one "recipient<TAB>text" line per message. Used as the outbox an
+// SMS/email gateway picks up from, and for tests.
+class FileSink : public NotificationSink {
+private:
+    std::string path;
+
+public:
+    explicit FileSink(const std::string& path) : path(path) {}
+
+    std::vector<size_t> deliver(const std::vector<Notification>& batch) override {
+        std::vector<size_t> failed;
+        std::ofstream out(path, std::ios::app);
+        std::string buffer;
+        for (const auto& n : batch) {
+            buffer += n.recipient;
+            buffer += '\t';
+            for (char ch : n.text) buffer += (ch == '\n' || ch == '\t') ? ' ' : ch;
+            buffer += '\n';
+        }
+        if (out) out << buffer << std::flush;
+        if (!out) {
+            for (size_t i = 0; i < batch.size(); i++) failed.push_back(i);
+        }
+        return failed;
+    }
+};
+
+struct PipelineConfig {
+    size_t batchSize = 100;         // messages per sink call
+    size_t queueCapacity = 1000;    // ready messages per channel
+    int maxAttempts = 5;
+    int64_t retryDelaySeconds = 30; // doubled after every failed attempt
+};
+
+struct PipelineStats {
+    long long delivered = 0;
+    long long failedAttempts = 0;
+    long long dropped = 0; // gave up after maxAttempts
+    long long batches = 0;
+    size_t scheduled = 0;  // waiting for their time
+    size_t retrying = 0;
+    size_t ready = 0;
+};
+
+class NotificationPipeline {
+private:
+    PipelineConfig config;
+    std::unique_ptr<NotificationSink> sinks[CHANNEL_COUNT];
+    std::multimap<int64_t, Notification> timeIndex;  // due time -> message
+    std::multimap<int64_t, Notification> retryQueue; // next attempt -> message
+    std::deque<Notification> ready[CHANNEL_COUNT];
+    PipelineStats stats;
+
+    std::mutex mtx;
+    std::mutex deliverMutex; // one sink call at a time; guards sinks
+    std::condition_variable wake;
+    std::atomic<bool> running{false};
+    std::thread timer;
+
+    static int64_t nowSeconds() {
+        return static_cast<int64_t>(time(nullptr));
+    }
+
+    // Moves due messages into the ready queues while they have room.
+    // Returns how many were moved.
+    size_t pullDue(std::multimap<int64_t, Notification>& index, int64_t now) {
+        size_t moved = 0;
+        auto it = index.begin();
+        while (it != index.end() && it->first <= now) {
+            std::deque<Notification>& queue = ready[it->second.channel];
+            if (queue.size() >= config.queueCapacity) {
+                ++it; // this channel is full, others may still have room
+                continue;
+            }
+            queue.push_back(std::move(it->second));
+            it = index.erase(it);
+            moved++;
+        }
+        return moved;
+    }
+
+    // Sends every ready message in batches. Called with `lock` (on mtx) held;
+    // it is released while a sink delivers.
+    int dispatch(std::unique_lock<std::mutex>& lock, int64_t now) {
+        int sent = 0;
+        for (int c = 0; c < CHANNEL_COUNT; c++) {
+            std::deque<Notification>& queue = ready[c];
+            while (!queue.empty()) {
+                size_t n = std::min(queue.size(), config.batchSize);
+                std::vector<Notification> batch(std::make_move_iterator(queue.begin()),
+                                                std::make_move_iterator(queue.begin() + n));
+                queue.erase(queue.begin(), queue.begin() + n);
+                stats.batches++;
+
+                lock.unlock();
+                std::vector<size_t> failed;
+                {
+                    std::lock_guard<std::mutex> sending(deliverMutex);
+                    if (sinks[c]) {
+                        failed = sinks[c]->deliver(batch);
+                    } else {
+                        for (size_t i = 0; i < n; i++) failed.push_back(i);
+                    }
+                }
+                lock.lock();
+
+                sent += static_cast<int>(n - failed.size());
+                stats.delivered += static_cast<long long>(n - failed.size());
+                for (size_t i : failed) {
+                    Notification& msg = batch[i];
+                    stats.failedAttempts++;
+                    if (++msg.attempts >= config.maxAttempts) {
+                        stats.dropped++;
+                        continue;
+                    }
+                    int64_t delay = config.retryDelaySeconds << (msg.attempts - 1);
+                    retryQueue.emplace(now + delay, std::move(msg));
+                }
+            }
+        }
+        return sent;
+    }
+
+    int tickLocked(std::unique_lock<std::mutex>& lock, int64_t now) {
+        int sent = 0;
+        // Each round empties the ready queues, so keep pulling until nothing due is left
+        size_t moved;
+        do {
+            moved = pullDue(retryQueue, now) + pullDue(timeIndex, now);
+            sent += dispatch(lock, now);
+        } while (moved > 0);
+        return sent;
+    }
+
+public:
+    explicit NotificationPipeline(const PipelineConfig& config = PipelineConfig()) : config(config) {}
+
+    ~NotificationPipeline() {
+        stop();
+    }
+
+    void setSink(Channel channel, std::unique_ptr<NotificationSink> sink) {
+        std::lock_guard<std::mutex> lock(deliverMutex);
+        sinks[channel] = std::move(sink);
+    }
+
+    // Schedules a message for the given time (seconds since the epoch).
+    // If it is due and its channel's ready queue is full, the caller dispatches first.
+    void schedule(int64_t dueAt, Notification msg) {
+        std::unique_lock<std::mutex> lock(mtx);
+        int64_t now = nowSeconds();
+        if (dueAt > now) {
+            timeIndex.emplace(dueAt, std::move(msg));
+            return;
+        }
+        if (ready[msg.channel].size() >= config.queueCapacity) dispatch(lock, now);
+        ready[msg.channel].push_back(std::move(msg));
+    }
+
+    void sendNow(Notification msg) {
+        schedule(nowSeconds(), std::move(msg));
+    }
+
+    // One dispatch round at the given time. Returns messages delivered.
+    int tick(int64_t now) {
+        std::unique_lock<std::mutex> lock(mtx);
+        return tickLocked(lock, now);
+    }
+
+    int tick() {
+        return tick(nowSeconds());
+    }
+
+    // Runs tick() every intervalMs on a background thread
+    void start(int intervalMs = 1000) {
+        if (running.exchange(true)) return;
+        timer = std::thread([this, intervalMs]() {
+            std::unique_lock<std::mutex> lock(mtx);
+            while (running) {
+                tickLocked(lock, nowSeconds());
+                wake.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return !running; });
+            }
+        });
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        wake.notify_all();
+        timer.join();
+    }
+
+    PipelineStats snapshot() {
+        std::lock_guard<std::mutex> lock(mtx);
+        PipelineStats s = stats;
+        s.scheduled = timeIndex.size();
+        s.retrying = retryQueue.size();
+        s.ready = 0;
+        for (const auto& q : ready) s.ready += q.size();
+        return s;
+    }
+};
+
+#endif
@@ -0,0 +1,364 @@
+// pg_async.h
+#ifndef PG_ASYNC_H
+#define PG_ASYNC_H
+
+// Non-blocking PostgreSQL access as C++20 coroutines (build with -std=c++20).
+// PgLoop is a single-threaded event loop: a coroutine waiting on a socket is
+// parked with its fd and resumed when poll() says the socket is ready, so one
+// thread keeps many queries in flight, one per connection in a PgPool.
+// PgConnection drives libpq's asynchronous calls (PQconnectStart/
+// PQconnectPoll, PQsendPrepare, PQsendQueryPrepared, PQflush,
+// PQconsumeInput) and never blocks the loop, apart from the host name lookup
+// in PQconnectStart (use hostaddr= to avoid it).
+// Results are returned as in libpq: check PQresultStatus() on them.
+
+#include <coroutine>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <libpq-fe.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+inline int pollSockets(WSAPOLLFD* fds, size_t n) { return WSAPoll(fds, static_cast<ULONG>(n), -1); }
+using PgPollFd = WSAPOLLFD;
+#else
+#include <cerrno>
+#include <poll.h>
+inline int pollSockets(pollfd* fds, size_t n) { return poll(fds, static_cast<nfds_t>(n), -1); }
+using PgPollFd = pollfd;
+#endif
+
+struct PgResultDeleter {
+    void operator()(PGresult* r) const { PQclear(r); }
+};
+using PgResult = std::unique_ptr<PGresult, PgResultDeleter>;
+
+// ---- PgTask ----
+
+// Lazily started coroutine: runs when awaited (or spawned on a PgLoop) and
+// resumes its awaiter when it finishes
+template <typename T>
+class PgTask;
+
+namespace pgdetail {
+
+template <typename T>
+struct Promise {
+    std::optional<T> value;
+    void return_value(T v) { value = std::move(v); }
+    T take() { return std::move(*value); }
+};
+
+template <>
+struct Promise<void> {
+    void return_void() {}
+    void take() {}
+};
+
+} // namespace pgdetail
+
+template <typename T>
+class PgTask {
+public:
+    struct promise_type : pgdetail::Promise<T> {
+        std::coroutine_handle<> continuation;
+
+        PgTask get_return_object() { return PgTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        void unhandled_exception() { std::terminate(); } // errors are results, not exceptions
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+    };
+
+    PgTask(PgTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    PgTask& operator=(PgTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    PgTask(const PgTask&) = delete;
+    PgTask& operator=(const PgTask&) = delete;
+    ~PgTask() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        handle.promise().continuation = caller;
+        return handle; // start the task; it resumes the caller when done
+    }
+    T await_resume() { return handle.promise().take(); }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit PgTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+};
+
+// ---- PgLoop ----
+
+class PgLoop {
+private:
+    struct Waiter {
+        int fd;
+        short events;
+        std::coroutine_handle<> handle;
+    };
+
+    // Fire-and-forget wrapper that owns a spawned task until it finishes
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    std::vector<Waiter> waiters;
+    std::vector<PgPollFd> fds;
+    std::deque<std::coroutine_handle<>> ready;
+    int active = 0; // spawned tasks not yet finished
+
+    static Detached runDetached(PgLoop* loop, PgTask<void> task) {
+        co_await task;
+        loop->active--;
+    }
+
+public:
+    struct IoAwaiter {
+        PgLoop* loop;
+        int fd;
+        short events;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { loop->waiters.push_back({fd, events, h}); }
+        void await_resume() const noexcept {}
+    };
+
+    IoAwaiter readable(int fd) { return {this, fd, POLLIN}; }
+    IoAwaiter writable(int fd) { return {this, fd, POLLOUT}; }
+    IoAwaiter readableOrWritable(int fd) { return {this, fd, POLLIN | POLLOUT}; }
+
+    // Resumes h on the next turn of the loop
+    void post(std::coroutine_handle<> h) {
+        ready.push_back(h);
+    }
+
+    // Starts a task; run() returns once every spawned task has finished
+    void spawn(PgTask<void> task) {
+        active++;
+        runDetached(this, std::move(task));
+    }
+
+    // Returns false if tasks are left waiting on nothing (a bug in the caller)
+    // or poll() fails
+    bool run() {
+        std::vector<std::coroutine_handle<>> woken;
+        while (true) {
+            while (!ready.empty()) {
+                std::coroutine_handle<> h = ready.front();
+                ready.pop_front();
+                h.resume();
+            }
+            if (active == 0) return true;
+            if (waiters.empty()) return false;
+
+            fds.resize(waiters.size());
+            for (size_t i = 0; i < waiters.size(); i++) {
+                fds[i].fd = waiters[i].fd;
+                fds[i].events = waiters[i].events;
+                fds[i].revents = 0;
+            }
+            if (pollSockets(fds.data(), fds.size()) < 0) {
+#ifndef _WIN32
+                if (errno == EINTR) continue;
+#endif
+                return false;
+            }
+            // Take the ready waiters out first: resuming them may add new ones
+            woken.clear();
+            for (size_t i = waiters.size(); i-- > 0;) {
+                if (fds[i].revents == 0) continue;
+                woken.push_back(waiters[i].handle);
+                waiters[i] = waiters.back();
+                waiters.pop_back();
+            }
+            for (std::coroutine_handle<> h : woken) h.resume();
+        }
+    }
+};
+
+// ---- PgConnection ----
+
+class PgConnection {
+private:
+    PgLoop& loop;
+    PGconn* conn = nullptr;
+
+    // Sends what libpq has buffered, then reads until the command is done.
+    // Returns the last result, like PQexec.
+    PgTask<PgResult> finish() {
+        int fd = PQsocket(conn);
+        int flushed;
+        while ((flushed = PQflush(conn)) == 1) {
+            // Keep reading too, or a server blocked on a full send buffer never drains ours
+            co_await loop.readableOrWritable(fd);
+            if (!PQconsumeInput(conn)) co_return PgResult(PQmakeEmptyPGresult(conn, PGRES_FATAL_ERROR));
+        }
+        if (flushed < 0) co_return PgResult(PQmakeEmptyPGresult(conn, PGRES_FATAL_ERROR));
+
+        PgResult last;
+        while (true) {
+            while (PQisBusy(conn)) {
+                co_await loop.readable(fd);
+                if (!PQconsumeInput(conn)) co_return PgResult(PQmakeEmptyPGresult(conn, PGRES_FATAL_ERROR));
+            }
+            PGresult* r = PQgetResult(conn);
+            if (!r) break;
+            last.reset(r);
+        }
+        co_return last;
+    }
+
+public:
+    explicit PgConnection(PgLoop& loop) : loop(loop) {}
+    PgConnection(const PgConnection&) = delete;
+    PgConnection& operator=(const PgConnection&) = delete;
+    ~PgConnection() {
+        if (conn) PQfinish(conn);
+    }
+
+    PgTask<bool> connect(std::string conninfo) {
+        conn = PQconnectStart(conninfo.c_str());
+        if (!conn || PQstatus(conn) == CONNECTION_BAD) co_return false;
+        PostgresPollingStatusType status = PGRES_POLLING_WRITING;
+        while (status != PGRES_POLLING_OK) {
+            if (status == PGRES_POLLING_FAILED) co_return false;
+            int fd = PQsocket(conn); // may change while libpq tries other addresses
+            if (status == PGRES_POLLING_READING) co_await loop.readable(fd);
+            else co_await loop.writable(fd);
+            status = PQconnectPoll(conn);
+        }
+        co_return PQsetnonblocking(conn, 1) == 0;
+    }
+
+    PgTask<PgResult> prepare(std::string name, std::string sql, int paramCount) {
+        if (!PQsendPrepare(conn, name.c_str(), sql.c_str(), paramCount, nullptr)) {
+            co_return PgResult(PQmakeEmptyPGresult(conn, PGRES_FATAL_ERROR));
+        }
+        co_return co_await finish();
+    }
+
+    // Runs a prepared statement with text parameters
+    PgTask<PgResult> execPrepared(std::string name, std::vector<std::string> params) {
+        std::vector<const char*> values;
+        for (const std::string& p : params) values.push_back(p.c_str());
+        if (!PQsendQueryPrepared(conn, name.c_str(), static_cast<int>(values.size()), values.data(),
+                                 nullptr, nullptr, 0)) {
+            co_return PgResult(PQmakeEmptyPGresult(conn, PGRES_FATAL_ERROR));
+        }
+        co_return co_await finish();
+    }
+
+    std::string errorMessage() const {
+        return conn ? PQerrorMessage(conn) : "out of memory";
+    }
+};
+
+// ---- PgPool ----
+
+// Connections shared by the coroutines of one loop; a query waits for an
+// idle connection, so at most size() queries are in flight
+class PgPool {
+private:
+    struct Acquire {
+        PgPool* pool;
+        PgConnection* conn = nullptr;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() {
+            if (pool->idle.empty()) return false;
+            conn = pool->idle.back();
+            pool->idle.pop_back();
+            return true;
+        }
+        void await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            pool->waiting.push_back(this);
+        }
+        PgConnection* await_resume() const noexcept { return conn; }
+    };
+
+    PgLoop& loop;
+    std::vector<std::unique_ptr<PgConnection>> connections;
+    std::vector<PgConnection*> idle;
+    std::deque<Acquire*> waiting; // first come, first served
+
+    // Hands the connection straight to the next waiter, so nobody can take it in between
+    void release(PgConnection* conn) {
+        if (waiting.empty()) {
+            idle.push_back(conn);
+            return;
+        }
+        Acquire* next = waiting.front();
+        waiting.pop_front();
+        next->conn = conn;
+        loop.post(next->handle);
+    }
+
+public:
+    explicit PgPool(PgLoop& loop) : loop(loop) {}
+
+    // Opens count connections; false (with errorMessage set) if any fails
+    PgTask<bool> connect(std::string conninfo, int count) {
+        for (int i = 0; i < count; i++) {
+            connections.push_back(std::make_unique<PgConnection>(loop));
+            if (!co_await connections.back()->connect(conninfo)) co_return false;
+            idle.push_back(connections.back().get());
+        }
+        co_return true;
+    }
+
+    // Prepares a statement on every connection
+    PgTask<bool> prepare(std::string name, std::string sql, int paramCount) {
+        for (auto& c : connections) {
+            PgResult r = co_await c->prepare(name, sql, paramCount);
+            if (!r || PQresultStatus(r.get()) != PGRES_COMMAND_OK) co_return false;
+        }
+        co_return true;
+    }
+
+    PgTask<PgResult> execPrepared(std::string name, std::vector<std::string> params) {
+        PgConnection* conn = co_await Acquire{this, nullptr, {}};
+        PgResult r = co_await conn->execPrepared(std::move(name), std::move(params));
+        release(conn);
+        co_return r;
+    }
+
+    std::string errorMessage() const {
+        return connections.empty() ? "" : connections.back()->errorMessage();
+    }
+
+    size_t size() const {
+        return connections.size();
+    }
+};
+
+#endif
@@ -1,128 +1,718 @@
 #include <iostream>
 #include <string>
 #include <ctime>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <array>
+#include <map>
+#include <climits>
+#include <fcntl.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "binary_records.h"
+#include "containers.h"
+#include "export.h"
+#include "loadgen.h"
+#include "metrics.h"
+#include "mvcc.h"
+#include "wal.h"
 using namespace std;
 
+enum TaskStatus {
+    STATUS_PENDING,
+    STATUS_IN_PROGRESS,
+    STATUS_COMPLETED,
+    STATUS_CANCELLED,
+    STATUS_COUNT
+};
+
+// Name used in the API and display ("Pending", "In_Progress", ...)
+const char* statusName(TaskStatus status) {
+    static const char* names[STATUS_COUNT] = {"Pending", "In_Progress", "Completed", "Cancelled"};
+    return status < STATUS_COUNT ? names[status] : "Unknown";
+}
+
+// STATUS_COUNT if the name is not a known status
+TaskStatus statusFromName(const string& name) {
+    for (int i = 0; i < STATUS_COUNT; i++) {
+        if (name == statusName(static_cast<TaskStatus>(i))) return static_cast<TaskStatus>(i);
+    }
+    return STATUS_COUNT;
+}
+
+// Outcome of TaskManagementSystem::tryEnqueue
+enum EnqueueResult {
+    ENQUEUE_OK,
+    ENQUEUE_DUPLICATE_ID,
+    ENQUEUE_UNKNOWN_STATUS,
+    ENQUEUE_CANCELLED,  // a new task can't start out cancelled
+    ENQUEUE_NOT_LOGGED // durable mode: added, but the log write failed
+};
+
+// Outcome of TaskManagementSystem::tryDequeue
+enum DequeueResult {
+    DEQUEUE_OK,
+    DEQUEUE_EMPTY,
+    DEQUEUE_NOT_LOGGED // durable mode: the log write failed, so the task stays queued
+};
+
 // I. Define a structure for task details
 struct Task {
     int taskID;
     string developerName;
+    int developerId; // Interned developerName, index into the per-developer counters
     string taskDescription;
     int priority; // Higher number = higher priority
-    string status; // Pending, In_Progress, Completed
+    TaskStatus status;
     string submissionDate; // Format: YYYY-MM-DD
     Task* next; // For linked list
+    long long seq; // Enqueue order, so equal priorities stay first-come-first-served
+    bool queued; // Still waiting in the priority queue
+    long long enqueuedAt; // Seconds since the epoch, for aging
+    int heapIndex; // Position in the priority queue, -1 if not queued
+    int row; // Storage order, used as the key in the query indexes
 };
 
-// Node for the priority queue (linked list-based)
-struct QueueNode {
-    Task* task;
-    QueueNode* next;
+// Aging: a waiting task gains one priority level every secondsPerLevel
+// seconds, so low-priority work is not starved. 0 turns aging off.
+struct AgingPolicy {
+    long long secondsPerLevel = 0;
+};
+
+// Published version of a task's changing fields. Snapshot readers take
+// these instead of reading the Task, whose other fields never change once
+// it is stored.
+struct TaskView {
+    const Task* task;
+    int priority;
+    TaskStatus status;
+    bool queued;
+};
+
+using TaskSnapshot = VersionStore<TaskView>::Snapshot;
+
+// Input for bulk loading; the submission date is set by the system
+struct TaskRecord {
+    int taskID;
+    string developerName;
+    string taskDescription;
+    int priority;
+    string status;
+};
+
+// ---- Binary task records (binary_records.h) ----
+
+const uint8_t TASK_RECORD_TYPE = 1;
+
+// A task read in place from a binary buffer; the strings point into it
+struct TaskFields {
+    int taskID;
+    string_view developerName;
+    string_view taskDescription;
+    int priority;
+    TaskStatus status;
+    uint64_t submissionDate; // packed, unpackDate() gives YYYY-MM-DD
+    bool queued;
+    long long enqueuedAt;
+    long long seq;
+};
+
+// Version 1 fields, in order
+void writeTask(BinaryWriter& w, const Task& t) {
+    w.putInt(t.taskID);
+    w.putDictString(t.developerName);
+    w.putString(t.taskDescription);
+    w.putInt(t.priority);
+    w.putUint(t.status);
+    w.putDate(t.submissionDate);
+    w.putUint(t.queued);
+    w.putInt(t.enqueuedAt);
+    w.putInt(t.seq);
+    w.endRecord();
+}
+
+// False if the record is not a task, is cut short or has an unknown status
+bool readTask(RecordCursor& c, TaskFields& t) {
+    if (c.recordType() != TASK_RECORD_TYPE) return false;
+    t.taskID = static_cast<int>(c.getInt());
+    t.developerName = c.getDictString();
+    t.taskDescription = c.getString();
+    t.priority = static_cast<int>(c.getInt());
+    uint64_t status = c.getUint();
+    t.status = status < STATUS_COUNT ? static_cast<TaskStatus>(status) : STATUS_COUNT;
+    t.submissionDate = c.getDate();
+    t.queued = c.getUint() != 0;
+    t.enqueuedAt = c.getInt();
+    t.seq = c.getInt();
+    return c.ok() && t.status != STATUS_COUNT;
+}
+
+// Filter for TaskManagementSystem::query(). Every field left at its
+// default matches all tasks; set fields are ANDed together.
+struct TaskQuery {
+    int taskID = -1;
+    string developer;                  // empty = any
+    TaskStatus status = STATUS_COUNT;  // STATUS_COUNT = any
+    int minPriority = INT_MIN;
+    int maxPriority = INT_MAX;
+    string fromDate;                   // YYYY-MM-DD, empty = open
+    string toDate;
+    bool queuedOnly = false;
 };
 
 class TaskManagementSystem {
 private:
-    Task* head; // Head of the linked list
-    QueueNode* front; // Front of the priority queue
-    QueueNode* rear; // Rear of the priority queue
+    // Heap order for the queue: the task that should run first comes first
+    struct TaskOrder {
+        const TaskManagementSystem* tms;
+        bool operator()(const Task* a, const Task* b) const { return tms->lowerPriority(b, a); }
+    };
+
+    // Keeps each task's heapIndex in step with its position in the queue
+    struct TaskHeapIndex {
+        void operator()(Task* t, size_t pos) const {
+            t->heapIndex = pos == SIZE_MAX ? -1 : static_cast<int>(pos);
+        }
+    };
+
+    IntrusiveList<Task> tasks; // Storage list, in submission order
+    DaryHeap<Task*, TaskOrder, 4, TaskHeapIndex> queue; // Priority queue (indexed 4-ary heap)
+    FlatHashMap<int, Task*> tasksById; // For status changes and recovery
+
+    // Aggregates kept up to date on every change, so dashboard counts are O(1)
+    FlatHashMap<string, int> developerIds;
+    vector<string> developerNames;
+    vector<array<int, STATUS_COUNT>> developerStatusCounts;
+    vector<int> developerQueuedCounts;
+    int statusCounts[STATUS_COUNT] = {};
+
+    // Query indexes. Rows are assigned in storage order and never reused,
+    // so every posting list is sorted just by appending to it.
+    vector<Task*> rows;
+    vector<vector<int>> developerPostings; // developer id -> rows
+    map<string, vector<int>> dateIndex;    // submission date -> rows
+
+    // Versions of every task by row, for lock-free snapshot reads
+    VersionStore<TaskView> versions;
     int taskCount; // To track number of tasks
+    long long nextSeq;
+    AgingPolicy aging;
+
+    // Durable mode: a change is acknowledged once its group commit is on disk
+    WriteAheadLog wal;
+    string checkpointPath;
+    long long checkpointEvery;
+    uint8_t replayVersion = 0; // log version of the file being recovered
+    bool durableMode = false;
+
+    // Aged priority, scaled by secondsPerLevel. Priority plus levels gained
+    // is priority + (now - enqueuedAt) / secondsPerLevel; "now" is the same
+    // for every task, so ordering by priority * secondsPerLevel - enqueuedAt
+    // gives the same order and never changes as time passes. Aging therefore
+    // costs nothing per tick, with no rescan of waiting tasks.
+    long long agedKey(int priority, long long enqueuedAt) const {
+        if (aging.secondsPerLevel <= 0) return priority;
+        return priority * aging.secondsPerLevel - enqueuedAt;
+    }
+
+    // Heap order: higher aged priority first, then earlier enqueue
+    bool lowerPriority(const Task* a, const Task* b) const {
+        long long ka = agedKey(a->priority, a->enqueuedAt), kb = agedKey(b->priority, b->enqueuedAt);
+        if (ka != kb) return ka < kb;
+        return a->seq > b->seq;
+    }
+
+    // Same order on published versions
+    bool lowerPriority(const TaskView& a, const TaskView& b) const {
+        long long ka = agedKey(a.priority, a.task->enqueuedAt), kb = agedKey(b.priority, b.task->enqueuedAt);
+        if (ka != kb) return ka < kb;
+        return a.task->seq > b.task->seq;
+    }
+
+    // Makes the task's current state visible to new snapshots
+    void publish(const Task* t) {
+        versions.update(t->row, TaskView{t, t->priority, t->status, t->queued});
+    }
+
+    // Takes a task out of the queue from any position in O(log n)
+    void removeFromQueue(Task* t) {
+        queue.erase(t->heapIndex);
+        markUnqueued(t);
+    }
+
+    // ---- Log record encoding ----
+    static void putInt(string& out, long long v) {
+        out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    static void putString(string& out, const string& s) {
+        putInt(out, static_cast<long long>(s.size()));
+        out += s;
+    }
+
+    static long long getInt(const string& in, size_t& pos) {
+        long long v = 0;
+        if (pos + sizeof(v) <= in.size()) memcpy(&v, in.data() + pos, sizeof(v));
+        pos += sizeof(v);
+        return v;
+    }
+
+    static string getString(const string& in, size_t& pos) {
+        size_t len = static_cast<size_t>(getInt(in, pos));
+        if (pos + len > in.size()) len = in.size() > pos ? in.size() - pos : 0;
+        string s = in.substr(min(pos, in.size()), len);
+        pos += len;
+        return s;
+    }
+
+    // Log format version, written as a 'V' record at the start of every log
+    // and checkpoint file. Files without one predate it: their 'T' records
+    // have no enqueuedAt, or (written between the two) have it with no marker.
+    static constexpr uint8_t logVersion = 2;
+
+    static string versionRecord() {
+        return string(1, 'V') + static_cast<char>(logVersion);
+    }
+
+    // 'V' = format version, 'T' = full task (enqueue / checkpoint), 'D' = dequeued,
+    // 'S' = status change, 'P' = priority change, 'C' = cancelled
+    static string encodeTask(const Task* t) {
+        string out(1, 'T');
+        putInt(out, t->taskID);
+        putInt(out, t->priority);
+        putInt(out, t->seq);
+        putInt(out, t->queued ? 1 : 0);
+        putInt(out, t->enqueuedAt);
+        putString(out, t->developerName);
+        putString(out, t->taskDescription);
+        putString(out, statusName(t->status));
+        putString(out, t->submissionDate);
+        return out;
+    }
+
+    // Logs a change; returns its ticket for logged(), 0 if not durable, or
+    // -1 if durable mode is on but the log has been lost (a failed reset)
+    long long logRecord(const string& record) {
+        if (!durableMode) return 0;
+        long long ticket = wal.append(record);
+        if (ticket > 0 && wal.recordCount() >= checkpointEvery) checkpoint();
+        return ticket;
+    }
+
+    // Waits for the group commit holding a logged change, so a change is on
+    // disk before it is acknowledged
+    bool logged(long long ticket) {
+        if (ticket < 0) return false;
+        return ticket == 0 || wal.waitDurable(ticket);
+    }
+
+    int internDeveloper(const string& name) {
+        if (const int* known = developerIds.find(name)) return *known;
+        int id = static_cast<int>(developerNames.size());
+        developerIds.insert(name, id);
+        developerNames.push_back(name);
+        developerStatusCounts.push_back({});
+        developerQueuedCounts.push_back(0);
+        developerPostings.emplace_back();
+        return id;
+    }
+
+    void setStatus(Task* t, TaskStatus status) {
+        statusCounts[t->status]--;
+        developerStatusCounts[t->developerId][t->status]--;
+        t->status = status;
+        statusCounts[status]++;
+        developerStatusCounts[t->developerId][status]++;
+        publish(t);
+    }
+
+    // Records that a task left the queue (dequeued or cancelled)
+    void markUnqueued(Task* t) {
+        if (!t->queued) return;
+        t->queued = false;
+        developerQueuedCounts[t->developerId]--;
+        publish(t);
+    }
+
+    // Adds a task to the storage list, id index and counters (not the queue)
+    void store(Task* t) {
+        tasks.pushBack(t);
+        tasksById[t->taskID] = t;
+        taskCount++;
+
+        t->developerId = internDeveloper(t->developerName);
+        statusCounts[t->status]++;
+        developerStatusCounts[t->developerId][t->status]++;
+        if (t->queued) developerQueuedCounts[t->developerId]++;
+
+        t->row = static_cast<int>(rows.size());
+        rows.push_back(t);
+        developerPostings[t->developerId].push_back(t->row);
+        dateIndex[t->submissionDate].push_back(t->row);
+        versions.insert(TaskView{t, t->priority, t->status, t->queued});
+    }
+
+    // First index at or after lo with v[index] >= target. Steps 1, 2, 4, ...
+    // from lo, then binary searches the last step, so skipping k entries
+    // costs O(log k) instead of O(log n).
+    static size_t gallop(const vector<int>& v, size_t lo, int target) {
+        size_t step = 1, hi = lo;
+        while (hi < v.size() && v[hi] < target) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        return lower_bound(v.begin() + lo, v.begin() + min(hi, v.size()), target) - v.begin();
+    }
+
+    // Appends rows present in both sorted lists, walking the shorter one
+    static void intersect(const vector<int>& a, const vector<int>& b, vector<int>& out) {
+        const vector<int>& small = a.size() <= b.size() ? a : b;
+        const vector<int>& large = a.size() <= b.size() ? b : a;
+        size_t pos = 0;
+        for (int row : small) {
+            pos = gallop(large, pos, row);
+            if (pos == large.size()) return;
+            if (large[pos] == row) out.push_back(row);
+        }
+    }
+
+    // devId is q.developer interned (-1 if q.developer is empty)
+    bool matches(const Task* t, const TaskQuery& q, int devId) const {
+        if (q.taskID >= 0 && t->taskID != q.taskID) return false;
+        if (devId >= 0 && t->developerId != devId) return false;
+        if (q.status != STATUS_COUNT && t->status != q.status) return false;
+        if (t->priority < q.minPriority || t->priority > q.maxPriority) return false;
+        if (!q.fromDate.empty() && t->submissionDate < q.fromDate) return false;
+        if (!q.toDate.empty() && t->submissionDate > q.toDate) return false;
+        if (q.queuedOnly && !t->queued) return false;
+        return true;
+    }
+
+    map<string, vector<int>>::const_iterator dateBegin(const TaskQuery& q) const {
+        return q.fromDate.empty() ? dateIndex.begin() : dateIndex.lower_bound(q.fromDate);
+    }
+
+    map<string, vector<int>>::const_iterator dateEnd(const TaskQuery& q) const {
+        return q.toDate.empty() ? dateIndex.end() : dateIndex.upper_bound(q.toDate);
+    }
+
+    // Reads a 'T' record; false unless it fills the record exactly
+    static bool decodeTask(const string& record, bool hasEnqueuedAt, Task* t) {
+        size_t pos = 1;
+        t->taskID = static_cast<int>(getInt(record, pos));
+        t->priority = static_cast<int>(getInt(record, pos));
+        t->seq = getInt(record, pos);
+        t->queued = getInt(record, pos) != 0;
+        t->enqueuedAt = hasEnqueuedAt ? getInt(record, pos) : 0;
+        t->heapIndex = -1;
+        t->developerName = getString(record, pos);
+        t->taskDescription = getString(record, pos);
+        t->status = statusFromName(getString(record, pos));
+        if (t->status == STATUS_COUNT) t->status = STATUS_PENDING;
+        t->submissionDate = getString(record, pos);
+        return pos == record.size();
+    }
+
+    // Applies one log record during recovery. Set replayVersion to 0 before
+    // each file; its 'V' record, if any, sets it.
+    void replay(const string& record) {
+        size_t pos = 1;
+        char op = record.empty() ? 0 : record[0];
+        if (op == 'V') {
+            replayVersion = record.size() > 1 ? static_cast<uint8_t>(record[1]) : 0;
+        } else if (op == 'T') {
+            if (replayVersion > logVersion) return;
+            Task* t = new Task;
+            bool ok = replayVersion >= 2 ? decodeTask(record, true, t)
+                                         : decodeTask(record, false, t) || decodeTask(record, true, t);
+            if (!ok || tasksById.contains(t->taskID)) {
+                delete t;
+                return;
+            }
+            store(t);
+            nextSeq = max(nextSeq, t->seq + 1);
+        } else if (replayVersion <= logVersion && (op == 'D' || op == 'S' || op == 'P' || op == 'C')) {
+            int taskID = static_cast<int>(getInt(record, pos));
+            Task** found = tasksById.find(taskID);
+            if (!found) return;
+            Task* t = *found;
+            if (op == 'D') {
+                markUnqueued(t);
+            } else if (op == 'S') {
+                TaskStatus status = statusFromName(getString(record, pos));
+                if (status == STATUS_CANCELLED) markUnqueued(t); // older logs set it this way
+                if (status != STATUS_COUNT) setStatus(t, status);
+            } else if (op == 'P') {
+                t->priority = static_cast<int>(getInt(record, pos));
+                publish(t);
+            } else {
+                markUnqueued(t);
+                setStatus(t, STATUS_CANCELLED);
+            }
+        }
+    }
 
 public:
-    TaskManagementSystem() {
-        head = nullptr;
-        front = nullptr;
-        rear = nullptr;
+    TaskManagementSystem() : queue(TaskOrder{this}) {
         taskCount = 0;
+        nextSeq = 0;
+        checkpointEvery = 0;
     }
 
-    // Helper function to get current date as string
+    // Helper function to get current date as string.
+    // Zero-padded (YYYY-MM-DD) so dates compare correctly as strings.
     string getCurrentDate() {
         time_t now = time(0);
         tm* ltm = localtime(&now);
-        string date = to_string(1900 + ltm->tm_year) + "-" + 
-                      to_string(1 + ltm->tm_mon) + "-" + 
-                      to_string(ltm->tm_mday);
+        char date[16];
+        strftime(date, sizeof(date), "%Y-%m-%d", ltm);
         return date;
     }
 
-    // II. Enqueue a task based on priority
-    void enqueue(int taskID, string devName, string desc, int priority, string status) {
+    // Durable mode: recovers the tasks saved at walPath (checkpoint + log),
+    // then logs every change there. Changes return only once their record
+    // is on disk (a false/ENQUEUE_NOT_LOGGED result means the write failed).
+    // A checkpoint is taken every checkpointEvery log records so replay
+    // time stays bounded.
+    // Call on an empty system. Returns false if the files can't be used.
+    bool enableDurability(const string& walPath, long long checkpointEvery = 100000) {
+        this->checkpointEvery = checkpointEvery;
+        checkpointPath = walPath + ".ckpt";
+
+        // A file from a newer version is refused rather than half read
+        auto apply = [this](const string& record) { replay(record); };
+        replayVersion = 0;
+        if (readRecords(checkpointPath, apply) < 0 || replayVersion > logVersion) return false;
+        replayVersion = 0;
+        if (readRecords(walPath, apply) < 0 || replayVersion > logVersion) return false;
+
+        // Rebuild the queue in one pass: heapify is O(n), n inserts would be O(n log n)
+        queue.clear();
+        for (Task* t : tasks) {
+            if (t->queued) queue.pushUnordered(t);
+        }
+        queue.heapify();
+
+        // Start from a fresh checkpoint, which also drops any torn record at the log's end
+        wal.setHeader(versionRecord());
+        if (!wal.open(walPath)) return false;
+        durableMode = true; // from here on a lost log fails changes instead of skipping them
+        return checkpoint();
+    }
+
+    // Writes every task to the checkpoint file and empties the log
+    bool checkpoint() {
+        TIME_OPERATION("tasks_checkpoint");
+        if (!wal.isOpen()) return false;
+        wal.sync();
+        vector<string> records;
+        records.reserve(taskCount + 1);
+        records.push_back(versionRecord());
+        for (Task* t : tasks) records.push_back(encodeTask(t));
+        if (!writeSnapshot(checkpointPath, records)) return false;
+        return wal.reset();
+    }
+
+    // Forces logged changes to disk (group commit otherwise batches them)
+    bool sync() {
+        return wal.sync();
+    }
+
+    // II. Enqueue a task based on priority. Never prints: callers report the result.
+    EnqueueResult tryEnqueue(int taskID, string devName, string desc, int priority, const string& status) {
+        TIME_OPERATION("tasks_enqueue");
+        if (tasksById.contains(taskID)) return ENQUEUE_DUPLICATE_ID;
+        TaskStatus taskStatus = statusFromName(status);
+        if (taskStatus == STATUS_COUNT) return ENQUEUE_UNKNOWN_STATUS;
+        if (taskStatus == STATUS_CANCELLED) return ENQUEUE_CANCELLED;
+
         // Create a new task
         Task* newTask = new Task;
         newTask->taskID = taskID;
-        newTask->developerName = devName;
-        newTask->taskDescription = desc;
+        newTask->developerName = std::move(devName);
+        newTask->taskDescription = std::move(desc);
         newTask->priority = priority;
-        newTask->status = status;
+        newTask->status = taskStatus;
         newTask->submissionDate = getCurrentDate();
-        newTask->next = nullptr;
+        newTask->seq = nextSeq++;
+        newTask->queued = true;
+        newTask->enqueuedAt = static_cast<long long>(time(0));
+        newTask->heapIndex = -1;
 
         // Add to linked list (for storage)
-        if (!head) {
-            head = newTask;
-        } else {
-            Task* temp = head;
-            while (temp->next) {
-                temp = temp->next;
-            }
-            temp->next = newTask;
-        }
-
-        // Create a queue node
-        QueueNode* newNode = new QueueNode;
-        newNode->task = newTask;
-        newNode->next = nullptr;
+        store(newTask);
 
         // Add to priority queue
-        if (!front) {
-            front = rear = newNode;
-        } else if (front->task->priority < priority) {
-            // Add to front if highest priority
-            newNode->next = front;
-            front = newNode;
-        } else {
-            QueueNode* current = front;
-            while (current->next && current->next->task->priority >= priority) {
-                current = current->next;
-            }
-            newNode->next = current->next;
-            current->next = newNode;
-            if (!newNode->next) rear = newNode;
+        queue.push(newTask);
+
+        if (!logged(logRecord(encodeTask(newTask)))) return ENQUEUE_NOT_LOGGED;
+        return ENQUEUE_OK;
+    }
+
+    // Console form of tryEnqueue: says why a task was refused
+    bool enqueue(int taskID, string devName, string desc, int priority, string status) {
+        EnqueueResult result = tryEnqueue(taskID, std::move(devName), std::move(desc), priority, status);
+        if (result == ENQUEUE_DUPLICATE_ID) cout << "Task ID " << taskID << " already exists!" << endl;
+        if (result == ENQUEUE_UNKNOWN_STATUS) cout << "Unknown status " << status << " for Task ID " << taskID << endl;
+        if (result == ENQUEUE_CANCELLED) cout << "Task ID " << taskID << " can't be queued as Cancelled!" << endl;
+        if (result == ENQUEUE_NOT_LOGGED) cout << "Task ID " << taskID << " could not be written to the task log!" << endl;
+        return result == ENQUEUE_OK;
+    }
+
+    // Loads many tasks at once. Strings are moved out of the records, the
+    // date is read once for the whole batch, and the queue is rebuilt with
+    // one O(n) heapify instead of a push per task. In durable mode it waits
+    // once, for the last record, so the batch is fsync'd in full groups rather
+    // than one record at a time. Tasks whose ID already exists, or whose
+    // status is unknown or Cancelled, are skipped.
+    // Returns how many were added, or -1 if the log write failed.
+    int enqueueBulk(vector<TaskRecord>&& records) {
+        TIME_OPERATION("tasks_enqueue_bulk");
+        string today = getCurrentDate();
+        long long now = static_cast<long long>(time(0));
+        // A small batch on a big queue is cheaper to sift in one by one
+        bool rebuild = records.size() * 4 >= queue.size();
+        queue.reserve(queue.size() + records.size());
+        tasksById.reserve(tasksById.size() + records.size());
+
+        int added = 0;
+        long long lastTicket = 0;
+        for (TaskRecord& r : records) {
+            TaskStatus status = statusFromName(r.status);
+            if (status == STATUS_COUNT || status == STATUS_CANCELLED || tasksById.contains(r.taskID)) continue;
+            Task* newTask = new Task;
+            newTask->taskID = r.taskID;
+            newTask->developerName = std::move(r.developerName);
+            newTask->taskDescription = std::move(r.taskDescription);
+            newTask->priority = r.priority;
+            newTask->status = status;
+            newTask->submissionDate = today;
+            newTask->seq = nextSeq++;
+            newTask->queued = true;
+            newTask->enqueuedAt = now;
+            newTask->heapIndex = -1;
+            store(newTask);
+            if (rebuild) queue.pushUnordered(newTask);
+            else queue.push(newTask);
+            lastTicket = logRecord(encodeTask(newTask));
+            added++;
         }
-        taskCount++;
+
+        if (rebuild) queue.heapify();
+        return logged(lastTicket) ? added : -1;
     }
 
-    // III. Dequeue a task (high-priority first)
-    Task* dequeue() {
-        if (!front) {
-            cout << "Queue is empty!" << endl;
+    // III. Dequeue a task (high-priority first). Returns nullptr if the queue
+    // is empty or, in durable mode, if the removal could not be logged: the
+    // task is then put back so it is not handed out and replayed as well.
+    Task* tryDequeue(DequeueResult* result = nullptr) {
+        TIME_OPERATION("tasks_dequeue");
+        if (result) *result = DEQUEUE_EMPTY;
+        if (queue.empty()) return nullptr;
+
+        Task* task = queue.top();
+        removeFromQueue(task); // stays in the linked list until the system is destroyed
+
+        string record(1, 'D');
+        putInt(record, task->taskID);
+        if (!logged(logRecord(record))) {
+            task->queued = true;
+            developerQueuedCounts[task->developerId]++;
+            queue.push(task); // keeps its seq, so it regains its place
+            publish(task);
+            if (result) *result = DEQUEUE_NOT_LOGGED;
             return nullptr;
         }
+        if (result) *result = DEQUEUE_OK;
+        return task;
+    }
 
-        QueueNode* temp = front;
-        Task* task = temp->task;
-        front = front->next;
-        if (!front) rear = nullptr;
-        delete temp; // Free queue node
-        taskCount--;
+    // Console form of tryDequeue
+    Task* dequeue() {
+        DequeueResult result;
+        Task* task = tryDequeue(&result);
+        if (result == DEQUEUE_EMPTY) cout << "Queue is empty!" << endl;
+        if (result == DEQUEUE_NOT_LOGGED) cout << "Dequeue could not be written to the task log!" << endl;
         return task;
     }
 
+    // Changes the priority of a queued task in O(log n)
+    bool updatePriority(int taskID, int priority) {
+        TIME_OPERATION("tasks_update_priority");
+        Task** found = tasksById.find(taskID);
+        if (!found || !(*found)->queued) return false;
+        Task* t = *found;
+        t->priority = priority;
+        queue.update(t->heapIndex);
+        publish(t);
+
+        string record(1, 'P');
+        putInt(record, taskID);
+        putInt(record, priority);
+        return logged(logRecord(record));
+    }
+
+    // Removes a queued task without running it, in O(log n).
+    // The task is kept with status "Cancelled".
+    bool cancel(int taskID) {
+        TIME_OPERATION("tasks_cancel");
+        Task** found = tasksById.find(taskID);
+        if (!found || !(*found)->queued) return false;
+        removeFromQueue(*found);
+        setStatus(*found, STATUS_CANCELLED);
+
+        string record(1, 'C');
+        putInt(record, taskID);
+        return logged(logRecord(record));
+    }
+
+    // Changing the policy re-orders the queue once, in O(n)
+    void setAgingPolicy(const AgingPolicy& policy) {
+        aging = policy;
+        queue.heapify();
+    }
+
+    // Changes a task's status (Pending, In_Progress, Completed). "Cancelled"
+    // goes through cancel(), which also takes the task out of the queue.
+    bool updateStatus(int taskID, const string& status) {
+        TIME_OPERATION("tasks_update_status");
+        TaskStatus newStatus = statusFromName(status);
+        if (newStatus == STATUS_CANCELLED) return cancel(taskID);
+        Task** found = tasksById.find(taskID);
+        if (!found || newStatus == STATUS_COUNT) return false;
+        setStatus(*found, newStatus);
+
+        string record(1, 'S');
+        putInt(record, taskID);
+        putString(record, status);
+        return logged(logRecord(record));
+    }
+
     // Helper function to convert linked list to array for sorting/searching
     Task** toArray(int &size) {
         size = taskCount;
         Task** arr = new Task*[size];
-        Task* current = head;
         int i = 0;
-        while (current) {
-            arr[i++] = current;
-            current = current->next;
-        }
+        for (Task* t : tasks) arr[i++] = t;
         return arr;
     }
 
     // IV. Binary search by Task ID (requires sorting by taskID first)
     Task* binarySearch(int taskID) {
+        TIME_OPERATION("tasks_binary_search");
         int size;
         Task** arr = toArray(size);
 
@@ -154,95 +744,719 @@ public:
     }
 
     // V. Bubble sort by priority or submission date
-    void bubbleSort(string sortBy) {
-        int size;
-        Task** arr = toArray(size);
+    // Sorts a snapshot and returns it, so the long sort runs alongside
+    // writers; the storage list itself is left in submission order.
+    vector<TaskView> bubbleSort(const string& sortBy) const {
+        TIME_OPERATION("tasks_bubble_sort");
+        TaskSnapshot snap = versions.snapshot();
+        vector<TaskView> arr;
+        arr.reserve(snap.size());
+        for (size_t row = 0; row < snap.size(); row++) {
+            if (const TaskView* v = snap.get(row)) arr.push_back(*v);
+        }
+        int size = static_cast<int>(arr.size());
 
         for (int i = 0; i < size - 1; i++) {
             for (int j = 0; j < size - i - 1; j++) {
                 bool swap = false;
                 if (sortBy == "priority") {
-                    if (arr[j]->priority < arr[j + 1]->priority) swap = true;
+                    if (arr[j].priority < arr[j + 1].priority) swap = true;
                 } else if (sortBy == "submissionDate") {
-                    if (arr[j]->submissionDate > arr[j + 1]->submissionDate) swap = true;
+                    if (arr[j].task->submissionDate > arr[j + 1].task->submissionDate) swap = true;
                 }
                 if (swap) {
-                    Task* temp = arr[j];
+                    TaskView temp = arr[j];
                     arr[j] = arr[j + 1];
                     arr[j + 1] = temp;
                 }
             }
         }
 
-        // Rebuild linked list
-        head = nullptr;
-        for (int i = 0; i < size; i++) {
-            arr[i]->next = nullptr;
-            if (!head) {
-                head = arr[i];
-            } else {
-                Task* temp = head;
-                while (temp->next) temp = temp->next;
-                temp->next = arr[i];
-            }
-        }
-        delete[] arr;
+        return arr;
     }
 
     // VI. Count tasks based on submission date threshold
     int countTasksByThreshold(string thresholdDate) {
+        TIME_OPERATION("tasks_count_by_threshold");
+        // Sum the date tree up to the threshold instead of walking every task
         int count = 0;
-        Task* current = head;
-        while (current) {
-            if (current->submissionDate <= thresholdDate) {
-                count++;
-            }
-            current = current->next;
+        for (auto it = dateIndex.begin(); it != dateIndex.end() && it->first <= thresholdDate; ++it) {
+            count += static_cast<int>(it->second.size());
         }
         return count;
     }
 
+    // Tasks matching every set field of q, in storage order.
+    // The planner picks the cheapest index for the query: the ID hash, the
+    // developer's postings, the date tree, or the developer postings
+    // intersected with each date in the range. Every other field is checked
+    // on the few candidates that are left. If plan is given, it is set to a
+    // short description of the chosen plan.
+    vector<Task*> query(const TaskQuery& q, string* plan = nullptr) {
+        TIME_OPERATION("tasks_query");
+        vector<Task*> result;
+
+        int dev = -1;
+        const vector<int>* devRows = nullptr;
+        if (!q.developer.empty()) {
+            dev = developerId(q.developer);
+            if (dev < 0) {
+                if (plan) *plan = "unknown developer";
+                return result;
+            }
+            devRows = &developerPostings[dev];
+        }
+
+        if (q.taskID >= 0) {
+            if (plan) *plan = "id lookup";
+            Task** found = tasksById.find(q.taskID);
+            if (found && matches(*found, q, dev)) result.push_back(*found);
+            return result;
+        }
+
+        bool dated = !q.fromDate.empty() || !q.toDate.empty();
+        size_t dateRows = 0;
+        if (dated) {
+            for (auto it = dateBegin(q); it != dateEnd(q); ++it) dateRows += it->second.size();
+        }
+
+        // Costs count posting entries read; reading a Task to filter it is a
+        // likely cache miss, so it counts as fetchCost entries.
+        const size_t fetchCost = 8;
+        vector<int> candidates;
+        const vector<int>* scan = &candidates;
+        if (devRows && dated) {
+            size_t scanDev = devRows->size();
+            size_t scanDates = dateRows;
+            size_t expected = rows.empty() ? 0 : scanDev * scanDates / rows.size();
+            size_t intersectCost = expected * fetchCost; // each date's list is intersected separately
+            for (auto it = dateBegin(q); it != dateEnd(q); ++it) intersectCost += min(scanDev, it->second.size());
+            if (intersectCost < min(scanDev, scanDates) * fetchCost) {
+                if (plan) *plan = "developer postings x date range (galloping)";
+                for (auto it = dateBegin(q); it != dateEnd(q); ++it) intersect(*devRows, it->second, candidates);
+                sort(candidates.begin(), candidates.end());
+            } else if (scanDev <= scanDates) {
+                if (plan) *plan = "developer postings";
+                scan = devRows;
+            } else {
+                if (plan) *plan = "date range";
+                for (auto it = dateBegin(q); it != dateEnd(q); ++it) {
+                    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+                }
+                sort(candidates.begin(), candidates.end());
+            }
+        } else if (devRows) {
+            if (plan) *plan = "developer postings";
+            scan = devRows;
+        } else if (dated) {
+            if (plan) *plan = "date range";
+            candidates.reserve(dateRows);
+            for (auto it = dateBegin(q); it != dateEnd(q); ++it) {
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+            }
+            sort(candidates.begin(), candidates.end());
+        } else if (q.queuedOnly && queue.size() < rows.size()) {
+            if (plan) *plan = "queue scan";
+            for (Task* t : queue) {
+                if (matches(t, q, dev)) result.push_back(t);
+            }
+            sort(result.begin(), result.end(), [](const Task* a, const Task* b) { return a->row < b->row; });
+            return result;
+        } else {
+            if (plan) *plan = "full scan";
+            for (Task* t : rows) {
+                if (matches(t, q, dev)) result.push_back(t);
+            }
+            return result;
+        }
+
+        for (int row : *scan) {
+            if (matches(rows[row], q, dev)) result.push_back(rows[row]);
+        }
+        return result;
+    }
+
+    // Snapshot of every task for lock-free reads: while it is held, a
+    // thread may read it while another enqueues or changes tasks.
+    // Release it (or let it go out of scope) when done.
+    TaskSnapshot snapshot() const {
+        return versions.snapshot();
+    }
+
+    // Writes every stored task to fd (a file, pipe or stdout) in the given
+    // format, from a snapshot. Strings are written straight from the tasks,
+    // not copied.
+    bool exportTasks(int fd, ExportFormat format) const {
+        TIME_OPERATION("tasks_export");
+        static const vector<ExportColumn> columns = {
+            {"taskID", COLUMN_INT}, {"developer", COLUMN_STRING}, {"description", COLUMN_STRING},
+            {"priority", COLUMN_INT}, {"status", COLUMN_STRING}, {"submissionDate", COLUMN_STRING},
+            {"queued", COLUMN_INT}};
+        TaskSnapshot snap = versions.snapshot();
+        ExportWriter out(fd, format, columns);
+        for (size_t row = 0; row < snap.size(); row++) {
+            const TaskView* v = snap.get(row);
+            if (!v) continue;
+            out.field(v->task->taskID);
+            out.field(v->task->developerName);
+            out.field(v->task->taskDescription);
+            out.field(v->priority);
+            out.field(statusName(v->status));
+            out.field(v->task->submissionDate);
+            out.field(v->queued ? 1 : 0);
+        }
+        return out.finish();
+    }
+
     // VII. Display all tasks in the queue
-    void displayTasks() {
-        QueueNode* current = front;
-        if (!current) {
+    // Reads a snapshot, so enqueues can continue while it prints
+    void displayTasks() const {
+        TIME_OPERATION("tasks_display");
+        TaskSnapshot snap = versions.snapshot();
+        vector<TaskView> ordered;
+        for (size_t row = 0; row < snap.size(); row++) {
+            const TaskView* v = snap.get(row);
+            if (v && v->queued) ordered.push_back(*v);
+        }
+        if (ordered.empty()) {
             cout << "Queue is empty!" << endl;
             return;
         }
+
+        // List in dequeue order
+        sort(ordered.begin(), ordered.end(), [this](const TaskView& a, const TaskView& b) { return lowerPriority(b, a); });
+
         cout << "Tasks in Queue:" << endl;
-        while (current) {
-            Task* task = current->task;
+        for (const TaskView& v : ordered) {
+            const Task* task = v.task;
             cout << "Task ID: " << task->taskID << ", Developer: " << task->developerName
-                 << ", Description: " << task->taskDescription << ", Priority: " << task->priority
-                 << ", Status: " << task->status << ", Submission Date: " << task->submissionDate << endl;
-            current = current->next;
+                 << ", Description: " << task->taskDescription << ", Priority: " << v.priority
+                 << ", Status: " << statusName(v.status) << ", Submission Date: " << task->submissionDate << endl;
         }
     }
 
+    // ---- Dashboard counts, all O(1) ----
+
+    // Interned id of a developer, or -1 if they have no tasks
+    int developerId(const string& name) const {
+        const int* id = developerIds.find(name);
+        return id ? *id : -1;
+    }
+
+    int countByStatus(TaskStatus status) const {
+        return statusCounts[status];
+    }
+
+    int countByDeveloper(int developerId, TaskStatus status) const {
+        if (developerId < 0 || developerId >= static_cast<int>(developerNames.size())) return 0;
+        return developerStatusCounts[developerId][status];
+    }
+
+    int countByDeveloper(const string& name, TaskStatus status) const {
+        return countByDeveloper(developerId(name), status);
+    }
+
+    // Tasks of the developer still waiting in the queue
+    int queuedByDeveloper(int developerId) const {
+        if (developerId < 0 || developerId >= static_cast<int>(developerNames.size())) return 0;
+        return developerQueuedCounts[developerId];
+    }
+
+    int queueSize() const {
+        return static_cast<int>(queue.size());
+    }
+
+    int size() const {
+        return taskCount;
+    }
+
     // Destructor to free memory
     ~TaskManagementSystem() {
-        // Free linked list
-        Task* currentTask = head;
-        while (currentTask) {
-            Task* temp = currentTask;
-            currentTask = currentTask->next;
-            delete temp;
+        wal.close();
+
+        // Free linked list (queued tasks are in it too)
+        tasks.deleteAll();
+    }
+};
+
+// Per-queue counters, readable at any time without locking the queue
+struct QueueStats {
+    string name;
+    int weight;
+    int core;
+    long long enqueued;
+    long long dequeued;
+    long long rejected; // duplicate IDs or unknown statuses
+    int depth;
+    int maxDepth;
+};
+
+// Many named task queues in one process, one per team.
+// Every queue has its own lock, so work on one team's queue never waits on
+// another's. Queues are sharded across cores: each is assigned a core, and
+// start() runs one worker pinned to each core that has queues, serving only
+// its own queues. Dequeues across queues are fair by deficit round robin:
+// each queue may take up to `weight` tasks per round before the next queue
+// gets its turn, and empty queues give up their turn.
+class QueueManager {
+public:
+    using Handler = function<void(const string& queueName, Task* task)>;
+
+private:
+    static constexpr int maxQueues = 1024;
+
+    struct TeamQueue {
+        string name;
+        int weight;
+        int core;
+        mutex mtx;
+        TaskManagementSystem tms;
+        atomic<long long> enqueued{0};
+        atomic<long long> dequeued{0};
+        atomic<long long> rejected{0};
+        atomic<int> depth{0};
+        atomic<int> maxDepth{0};
+    };
+
+    // Round-robin position for one consumer (a worker or dequeueFair callers)
+    struct Scheduler {
+        mutex mtx;
+        size_t cursor = 0;
+        int deficit = 0;
+        vector<int> queues; // indexes of the queues this consumer serves
+    };
+
+    struct Shard {
+        Scheduler scheduler;
+        mutex waitMutex;
+        condition_variable wake;
+        thread worker;
+    };
+
+    unique_ptr<TeamQueue> queues[maxQueues];
+    atomic<int> queueCount{0};
+    mutex registryMutex; // only for adding queues and name lookups
+    unordered_map<string, int> queueIds;
+
+    int cores;
+    vector<unique_ptr<Shard>> shards; // one per core
+    Scheduler global;                 // for dequeueFair()
+    atomic<bool> running{false};
+
+    // Takes the next task by deficit round robin over s.queues
+    Task* nextFair(Scheduler& s, int* queueOut) {
+        lock_guard<mutex> lock(s.mtx);
+        size_t n = s.queues.size();
+        for (size_t tried = 0; tried <= n && n > 0; ) {
+            TeamQueue& q = *queues[s.queues[s.cursor % n]];
+            if (s.deficit <= 0) s.deficit = q.weight; // new turn
+            Task* task = nullptr;
+            {
+                lock_guard<mutex> qlock(q.mtx);
+                task = q.tms.tryDequeue();
+            }
+            if (task) {
+                q.dequeued++;
+                q.depth--;
+                if (queueOut) *queueOut = s.queues[s.cursor % n];
+                if (--s.deficit == 0) s.cursor++;
+                return task;
+            }
+            // Empty queues don't bank their unused turn
+            s.deficit = 0;
+            s.cursor++;
+            tried++;
         }
+        return nullptr;
+    }
+
+    static void pinToCore(thread& t, int core) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+        (void)t;
+        (void)core;
+#endif
+    }
 
-        // Free queue
-        QueueNode* currentNode = front;
-        while (currentNode) {
-            QueueNode* temp = currentNode;
-            currentNode = currentNode->next;
-            delete temp; // Task pointers already freed via linked list
+public:
+    explicit QueueManager(int cores = 0) {
+        this->cores = cores > 0 ? cores : max(1, static_cast<int>(thread::hardware_concurrency()));
+        for (int i = 0; i < this->cores; i++) shards.emplace_back(new Shard);
+    }
+
+    ~QueueManager() {
+        stop();
+    }
+
+    // Adds a queue served `weight` tasks per round. Returns its id, or -1 if
+    // the name is taken or the manager is full. Add queues before start().
+    int addQueue(const string& name, int weight = 1) {
+        lock_guard<mutex> lock(registryMutex);
+        int id = queueCount.load();
+        if (queueIds.count(name) || id >= maxQueues || weight < 1) return -1;
+
+        TeamQueue* q = new TeamQueue;
+        q->name = name;
+        q->weight = weight;
+        q->core = id % cores;
+        queues[id].reset(q);
+        queueIds[name] = id;
+
+        Shard& shard = *shards[q->core];
+        {
+            lock_guard<mutex> slock(shard.scheduler.mtx);
+            shard.scheduler.queues.push_back(id);
+        }
+        {
+            lock_guard<mutex> glock(global.mtx);
+            global.queues.push_back(id);
         }
+        queueCount.store(id + 1);
+        return id;
+    }
+
+    // Id of a queue, or -1. Look it up once and use the id afterwards.
+    int queueId(const string& name) {
+        lock_guard<mutex> lock(registryMutex);
+        auto it = queueIds.find(name);
+        return it == queueIds.end() ? -1 : it->second;
+    }
+
+    bool enqueue(int queue, int taskID, string devName, string desc, int priority, string status) {
+        if (queue < 0 || queue >= queueCount.load()) return false;
+        TeamQueue& q = *queues[queue];
+        bool ok;
+        {
+            lock_guard<mutex> lock(q.mtx);
+            ok = q.tms.tryEnqueue(taskID, std::move(devName), std::move(desc), priority, status) == ENQUEUE_OK;
+        }
+        if (!ok) {
+            q.rejected++;
+            return false;
+        }
+        q.enqueued++;
+        int depth = ++q.depth;
+        int seen = q.maxDepth.load();
+        while (depth > seen && !q.maxDepth.compare_exchange_weak(seen, depth)) {}
+
+        if (running) {
+            Shard& shard = *shards[q.core];
+            lock_guard<mutex> wlock(shard.waitMutex);
+            shard.wake.notify_one();
+        }
+        return true;
+    }
+
+    // Highest-priority task of one queue, or nullptr if it is empty (or its
+    // log write failed, which leaves the task queued)
+    Task* dequeue(int queue) {
+        if (queue < 0 || queue >= queueCount.load()) return nullptr;
+        TeamQueue& q = *queues[queue];
+        Task* task = nullptr;
+        {
+            lock_guard<mutex> lock(q.mtx);
+            task = q.tms.tryDequeue();
+        }
+        if (task) {
+            q.dequeued++;
+            q.depth--;
+        }
+        return task;
+    }
+
+    // Next task across all queues by weighted deficit round robin, or nullptr
+    // if every queue is empty. queueOut, if given, receives the queue's id.
+    Task* dequeueFair(int* queueOut = nullptr) {
+        return nextFair(global, queueOut);
+    }
+
+    // Direct access to one queue's system (e.g. for queries); hold the
+    // returned lock while using it
+    TaskManagementSystem& queue(int queue, unique_lock<mutex>& lock) {
+        TeamQueue& q = *queues[queue];
+        lock = unique_lock<mutex>(q.mtx);
+        return q.tms;
+    }
+
+    // Runs handler on every task as it arrives, with one worker pinned to
+    // each core that has queues
+    void start(Handler handler) {
+        if (running.exchange(true)) return;
+        for (int c = 0; c < cores; c++) {
+            Shard& shard = *shards[c];
+            shard.worker = thread([this, &shard, handler]() {
+                while (running) {
+                    int queueId = -1;
+                    Task* task = nextFair(shard.scheduler, &queueId);
+                    if (task) {
+                        handler(queues[queueId]->name, task);
+                        continue;
+                    }
+                    unique_lock<mutex> lock(shard.waitMutex);
+                    shard.wake.wait_for(lock, chrono::milliseconds(50));
+                }
+            });
+            pinToCore(shard.worker, c);
+        }
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        for (auto& shard : shards) {
+            {
+                lock_guard<mutex> lock(shard->waitMutex);
+                shard->wake.notify_all();
+            }
+            if (shard->worker.joinable()) shard->worker.join();
+        }
+    }
+
+    QueueStats stats(int queue) const {
+        const TeamQueue& q = *queues[queue];
+        return QueueStats{q.name, q.weight, q.core, q.enqueued.load(), q.dequeued.load(),
+                          q.rejected.load(), q.depth.load(), q.maxDepth.load()};
+    }
+
+    vector<QueueStats> allStats() const {
+        vector<QueueStats> out;
+        int n = queueCount.load();
+        for (int i = 0; i < n; i++) out.push_back(stats(i));
+        return out;
+    }
+
+    int size() const {
+        return queueCount.load();
     }
 };
 
+// Encodes, scans and decodes `count` generated tasks, best of 5 runs each.
+// quize --binary-bench [tasks]
+int runBinaryBench(int count) {
+    static const char* words[] = {"Fix", "login", "bug", "in", "the", "payment", "module", "update", "UI",
+                                  "migrate", "database", "schema", "add", "tests", "for", "export"};
+    mt19937 rng(42);
+    vector<Task> tasks(count);
+    for (int i = 0; i < count; i++) {
+        Task& t = tasks[i];
+        t.taskID = 100000 + i;
+        t.developerName = "developer" + to_string(rng() % 40);
+        for (int w = 3 + static_cast<int>(rng() % 6); w > 0; w--) {
+            t.taskDescription += words[rng() % 16];
+            if (w > 1) t.taskDescription += ' ';
+        }
+        t.priority = static_cast<int>(rng() % 10);
+        t.status = static_cast<TaskStatus>(rng() % STATUS_COUNT);
+        t.submissionDate = unpackDate(packDate("2024-01-01") + rng() % 900);
+        t.queued = rng() % 2;
+        t.enqueuedAt = 1700000000 + i * 7;
+        t.seq = i;
+    }
+
+    auto best = [](auto run) {
+        double fastest = 1e30;
+        for (int r = 0; r < 5; r++) {
+            auto start = chrono::steady_clock::now();
+            run();
+            fastest = min(fastest, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        return fastest;
+    };
+
+    string buffer;
+    double encode = best([&]() {
+        BinaryWriter w(TASK_RECORD_TYPE);
+        w.reserve(buffer.size() + 64); // the previous run's size
+        for (const Task& t : tasks) writeTask(w, t);
+        buffer = w.take();
+    });
+
+    // Zero-copy: fields are read in place, nothing is allocated
+    long long prioritySum = 0;
+    int forOneDeveloper = 0;
+    double scan = best([&]() {
+        prioritySum = 0;
+        forOneDeveloper = 0;
+        BinaryReader reader(buffer);
+        RecordCursor c;
+        TaskFields f;
+        while (reader.next(c) && readTask(c, f)) {
+            prioritySum += f.priority;
+            forOneDeveloper += f.developerName == "developer7";
+        }
+    });
+
+    vector<Task> decoded;
+    double decode = best([&]() {
+        decoded.assign(count, Task());
+        BinaryReader reader(buffer);
+        RecordCursor c;
+        TaskFields f;
+        for (int i = 0; i < count && reader.next(c) && readTask(c, f); i++) {
+            Task& t = decoded[i];
+            t.taskID = f.taskID;
+            t.developerName = f.developerName;
+            t.taskDescription = f.taskDescription;
+            t.priority = f.priority;
+            t.status = f.status;
+            t.submissionDate = unpackDate(f.submissionDate);
+            t.queued = f.queued;
+            t.enqueuedAt = f.enqueuedAt;
+            t.seq = f.seq;
+        }
+    });
+
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        const Task& a = tasks[i];
+        const Task& b = decoded[i];
+        mismatches += a.taskID != b.taskID || a.developerName != b.developerName ||
+                      a.taskDescription != b.taskDescription || a.priority != b.priority || a.status != b.status ||
+                      a.submissionDate != b.submissionDate || a.queued != b.queued ||
+                      a.enqueuedAt != b.enqueuedAt || a.seq != b.seq;
+    }
+
+    double mb = static_cast<double>(buffer.size()) / 1e6;
+    auto report = [&](const char* what, double seconds) {
+        cout << what << seconds * 1e9 / count << " ns/task, " << static_cast<long long>(count / seconds)
+             << " tasks/s, " << static_cast<long long>(mb / seconds) << " MB/s" << endl;
+    };
+    cout << count << " tasks in " << buffer.size() << " bytes ("
+         << static_cast<double>(buffer.size()) / count << " bytes/task)" << endl;
+    report("Encode:           ", encode);
+    report("Zero-copy scan:   ", scan);
+    report("Decode to objects:", decode);
+    cout << "Scan check: priority sum " << prioritySum << ", " << forOneDeveloper << " tasks for developer7" << endl;
+    cout << (mismatches == 0 ? "Round trip exact." : "Round trip mismatches: " + to_string(mismatches)) << endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Seeded enqueue/dequeue streams over a few team queues.
+// quize --loadgen [operations] [rate/s, 0 = max] [threads] [seed] [trace file to write]
+// quize --replay <trace file> [rate/s] [threads]
+int runLoad(int argc, char* argv[], int arg) {
+    const vector<LoadKind> kinds = {{"enqueue", 55, true}, {"dequeue", 45, false}};
+    bool replay = string(argv[arg]) == "--replay";
+    Workload w;
+    LoadConfig config;
+    if (replay) {
+        if (argc <= arg + 1 || !Workload::load(argv[arg + 1], kinds, w)) {
+            cout << "Could not read trace " << (argc > arg + 1 ? argv[arg + 1] : "") << endl;
+            return 1;
+        }
+        config.rate = argc > arg + 2 ? atof(argv[arg + 2]) : 0;
+        config.threads = argc > arg + 3 ? atoi(argv[arg + 3]) : 1;
+    } else {
+        long operations = argc > arg + 1 ? atol(argv[arg + 1]) : 100000;
+        config.rate = argc > arg + 2 ? atof(argv[arg + 2]) : 0;
+        config.threads = argc > arg + 3 ? atoi(argv[arg + 3]) : 1;
+        uint64_t seed = argc > arg + 4 ? strtoull(argv[arg + 4], nullptr, 10) : 1;
+        if (operations <= 0) {
+            cout << "Usage: quize --loadgen [operations] [rate] [threads] [seed] [trace file]" << endl;
+            return 1;
+        }
+        w = Workload::generate(kinds, static_cast<size_t>(operations), seed);
+        if (argc > arg + 5 && !w.save(argv[arg + 5])) {
+            cout << "Could not write trace " << argv[arg + 5] << endl;
+            return 1;
+        }
+    }
+    if (config.threads < 1 || config.rate < 0) {
+        cout << "Threads must be at least 1 and the rate not negative." << endl;
+        return 1;
+    }
+
+    static const char* developers[] = {"Alice", "Bob", "Charlie", "Dana", "Elias", "Fatima"};
+    QueueManager manager;
+    const int teams = 4;
+    for (int i = 0; i < teams; i++) manager.addQueue("team" + to_string(i));
+    atomic<long long> emptyDequeues{0};
+
+    // A dequeue that finds every queue empty is an answer, not a failure
+    LoadReport report = runWorkload(w, config, [&](const LoadEvent& e, int) {
+        if (e.kind == 0) {
+            return manager.enqueue(static_cast<int>(e.actor % teams), static_cast<int>(e.actor) + 1,
+                                   developers[e.arg % 6], "Load task " + to_string(e.actor),
+                                   static_cast<int>((e.arg >> 8) % 10), "Pending");
+        }
+        if (!manager.dequeueFair()) emptyDequeues++;
+        return true;
+    });
+
+    cout << (replay ? "Replayed " : "Generated ") << w.events.size() << " events, " << config.threads
+         << " thread(s), "
+         << (config.rate > 0 ? to_string(static_cast<long long>(config.rate)) + " ops/s target" : "unthrottled")
+         << endl;
+    printLoadReport(report, cout);
+    long long left = 0;
+    for (const QueueStats& q : manager.allStats()) left += q.depth;
+    cout << "Dequeues that found nothing: " << emptyDequeues << ", tasks left queued: " << left << endl;
+    return report.total.failures > 0 ? 1 : 0;
+}
+
 // Main function to test the system
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && (string(argv[1]) == "--loadgen" || string(argv[1]) == "--replay")) {
+        return runLoad(argc, argv, 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--binary-bench") {
+        int count = argc > 2 ? atoi(argv[2]) : 1000000;
+        return runBinaryBench(count > 0 ? count : 1000000);
+    }
     TaskManagementSystem tms;
 
+    // quize --durable <log file>: recover saved tasks and log every change
+    // quize --durable <log file> --export <csv|jsonl|columnar> <file or ->:
+    //   write the recovered tasks out and exit ("-" = stdout, e.g. to a pipe)
+    // quize --metrics: print Prometheus metrics at the end
+    // quize --loadgen / --replay: see runLoad
+    // quize --binary-bench [tasks]: binary record round trip
+    string exportFormat, exportPath;
+    bool durable = false;
+    bool printMetrics = false;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--metrics") printMetrics = true;
+    }
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--durable") {
+            if (!tms.enableDurability(argv[++i])) {
+                cout << "Could not open task log " << argv[i] << endl;
+                return 1;
+            }
+            durable = true;
+        } else if (arg == "--export" && i + 2 < argc) {
+            exportFormat = argv[++i];
+            exportPath = argv[++i];
+        }
+    }
+
+#ifndef DISABLE_METRICS
+    Metrics::registerGauge("tasks_stored", "Tasks in the system", [&tms]() { return tms.size(); });
+    Metrics::registerGauge("tasks_queued", "Tasks waiting in the queue", [&tms]() { return tms.queueSize(); });
+#endif
+
+    if (!exportPath.empty()) {
+        ExportFormat format;
+        if (!exportFormatFromName(exportFormat, format)) {
+            cerr << "Unknown export format " << exportFormat << " (use csv, jsonl or columnar)" << endl;
+            return 1;
+        }
+        int fd = exportPath == "-" ? 1 : open(exportPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || !tms.exportTasks(fd, format)) {
+            cerr << "Could not export tasks to " << exportPath << endl;
+            return 1;
+        }
+        if (fd != 1) close(fd);
+        return 0;
+    }
+    if (durable) {
+        cout << "Recovered " << tms.size() << " task(s), " << tms.queueSize() << " queued." << endl;
+    }
+
     // Adding some tasks
     tms.enqueue(101, "Alice", "Fix login bug", 3, "Pending");
     tms.enqueue(102, "Bob", "Update UI", 1, "In_Progress");
@@ -271,13 +1485,20 @@ int main() {
 
     // Sort by priority
     cout << "\nSorting by priority:" << endl;
-    tms.bubbleSort("priority");
-    tms.displayTasks();
+    for (const TaskView& v : tms.bubbleSort("priority")) {
+        cout << "Task ID: " << v.task->taskID << ", Priority: " << v.priority << endl;
+    }
+
+    // Per-developer counts
+    cout << "\nPending tasks for Alice: " << tms.countByDeveloper("Alice", STATUS_PENDING) << endl;
+    cout << "In-progress tasks overall: " << tms.countByStatus(STATUS_IN_PROGRESS) << endl;
 
     // Count tasks by submission date threshold
     cout << "\nCounting tasks with submission date <= 2025-05-27:" << endl;
     int count = tms.countTasksByThreshold("2025-05-27");
     cout << "Tasks count: " << count << endl;
 
+    if (printMetrics) cout << "\n" << Metrics::prometheus();
+
     return 0;
 }
\ No newline at end of file
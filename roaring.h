@@ -0,0 +1,365 @@
+// roaring.h
+#ifndef ROARING_H
+#define ROARING_H
+
+// Compressed bitmap of 32-bit ids in the style of Roaring bitmaps.
+// Ids are split by their high 16 bits into containers of up to 65536 values.
+// A container holds a sorted array of the low 16 bits while it has at most
+// arrayMax values (2 bytes each) and switches to a plain 8 KB bitmap above
+// that, so sparse and dense sets both stay small. AND/OR work container by
+// container: bitmap pairs word by word, arrays by merging or probing the
+// bitmap. andCount() counts an intersection of any number of sets without
+// building it, and unionOf() merges many sets in one pass.
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+class RoaringBitmap {
+private:
+    static constexpr size_t arrayMax = 4096;
+    static constexpr size_t bitmapWords = 1024;
+
+    // Bit count without relying on -mpopcnt (the builtin is a library call
+    // without it); written so the word loops below vectorize
+    static uint32_t popcount(uint64_t x) {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return static_cast<uint32_t>((x * 0x0101010101010101ull) >> 56);
+    }
+
+    struct Container {
+        std::vector<uint16_t> array; // sorted, while not a bitmap
+        std::vector<uint64_t> bits;  // bitmapWords words once dense
+        uint32_t count = 0;
+
+        bool isBitmap() const { return !bits.empty(); }
+
+        bool contains(uint16_t v) const {
+            if (isBitmap()) return (bits[v >> 6] >> (v & 63)) & 1;
+            return std::binary_search(array.begin(), array.end(), v);
+        }
+
+        void toBitmap() {
+            bits.assign(bitmapWords, 0);
+            for (uint16_t v : array) bits[v >> 6] |= uint64_t(1) << (v & 63);
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        // Back to an array if a result turned out sparse
+        void shrink() {
+            if (!isBitmap() || count > arrayMax) return;
+            array.reserve(count);
+            for (size_t w = 0; w < bitmapWords; w++) {
+                for (uint64_t b = bits[w]; b; b &= b - 1) array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(b)));
+            }
+            bits.clear();
+            bits.shrink_to_fit();
+        }
+
+        void add(uint16_t v) {
+            if (isBitmap()) {
+                uint64_t& w = bits[v >> 6];
+                uint64_t bit = uint64_t(1) << (v & 63);
+                if (!(w & bit)) {
+                    w |= bit;
+                    count++;
+                }
+                return;
+            }
+            if (array.empty() || array.back() < v) {
+                array.push_back(v); // ids usually arrive in order
+            } else {
+                auto it = std::lower_bound(array.begin(), array.end(), v);
+                if (*it == v) return;
+                array.insert(it, v);
+            }
+            if (++count > arrayMax) toBitmap();
+        }
+    };
+
+    std::vector<uint16_t> keys; // high 16 bits, sorted
+    std::vector<Container> containers;
+
+    static uint32_t andCount(const Container& a, const Container& b) {
+        if (a.isBitmap() && b.isBitmap()) {
+            uint32_t n = 0;
+            for (size_t w = 0; w < bitmapWords; w++) n += popcount(a.bits[w] & b.bits[w]);
+            return n;
+        }
+        if (a.isBitmap() || b.isBitmap()) {
+            const Container& arr = a.isBitmap() ? b : a;
+            const Container& map = a.isBitmap() ? a : b;
+            uint32_t n = 0;
+            for (uint16_t v : arr.array) n += (map.bits[v >> 6] >> (v & 63)) & 1;
+            return n;
+        }
+        uint32_t n = 0;
+        size_t i = 0, j = 0;
+        while (i < a.array.size() && j < b.array.size()) {
+            if (a.array[i] < b.array[j]) i++;
+            else if (a.array[i] > b.array[j]) j++;
+            else n++, i++, j++;
+        }
+        return n;
+    }
+
+    // Container for the given high bits, or nullptr
+    const Container* container(uint16_t high) const {
+        auto it = std::lower_bound(keys.begin(), keys.end(), high);
+        if (it == keys.end() || *it != high) return nullptr;
+        return &containers[it - keys.begin()];
+    }
+
+    // |a AND b AND ...| for bitmap containers, a whole container at a time
+    static uint64_t andCountBitmaps(const std::vector<const Container*>& parts) {
+        uint64_t words[bitmapWords];
+        std::copy(parts[0]->bits.begin(), parts[0]->bits.end(), words);
+        for (size_t s = 1; s < parts.size(); s++) {
+            const uint64_t* bits = parts[s]->bits.data();
+            for (size_t w = 0; w < bitmapWords; w++) words[w] &= bits[w];
+        }
+        uint64_t n = 0;
+        for (size_t w = 0; w < bitmapWords; w++) n += popcount(words[w]);
+        return n;
+    }
+
+    static Container intersect(const Container& a, const Container& b) {
+        Container out;
+        if (a.isBitmap() && b.isBitmap()) {
+            out.bits.resize(bitmapWords);
+            for (size_t w = 0; w < bitmapWords; w++) {
+                out.bits[w] = a.bits[w] & b.bits[w];
+                out.count += popcount(out.bits[w]);
+            }
+            out.shrink();
+        } else if (a.isBitmap() || b.isBitmap()) {
+            const Container& arr = a.isBitmap() ? b : a;
+            const Container& map = a.isBitmap() ? a : b;
+            for (uint16_t v : arr.array) {
+                if ((map.bits[v >> 6] >> (v & 63)) & 1) out.array.push_back(v);
+            }
+            out.count = static_cast<uint32_t>(out.array.size());
+        } else {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                  std::back_inserter(out.array));
+            out.count = static_cast<uint32_t>(out.array.size());
+        }
+        return out;
+    }
+
+    static Container unite(const Container& a, const Container& b) {
+        Container out;
+        if (a.isBitmap() || b.isBitmap() || a.count + b.count > arrayMax) {
+            out.bits.assign(bitmapWords, 0);
+            for (const Container* c : {&a, &b}) {
+                if (c->isBitmap()) {
+                    for (size_t w = 0; w < bitmapWords; w++) out.bits[w] |= c->bits[w];
+                } else {
+                    for (uint16_t v : c->array) out.bits[v >> 6] |= uint64_t(1) << (v & 63);
+                }
+            }
+            for (size_t w = 0; w < bitmapWords; w++) out.count += popcount(out.bits[w]);
+            out.shrink();
+        } else {
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                           std::back_inserter(out.array));
+            out.count = static_cast<uint32_t>(out.array.size());
+        }
+        return out;
+    }
+
+public:
+    void add(uint32_t id) {
+        uint16_t high = static_cast<uint16_t>(id >> 16);
+        size_t i;
+        if (!keys.empty() && keys.back() == high) {
+            i = keys.size() - 1;
+        } else {
+            i = std::lower_bound(keys.begin(), keys.end(), high) - keys.begin();
+            if (i == keys.size() || keys[i] != high) {
+                keys.insert(keys.begin() + i, high);
+                containers.insert(containers.begin() + i, Container());
+            }
+        }
+        containers[i].add(static_cast<uint16_t>(id & 0xFFFF));
+    }
+
+    bool contains(uint32_t id) const {
+        const Container* c = container(static_cast<uint16_t>(id >> 16));
+        return c && c->contains(static_cast<uint16_t>(id & 0xFFFF));
+    }
+
+    uint64_t cardinality() const {
+        uint64_t n = 0;
+        for (const Container& c : containers) n += c.count;
+        return n;
+    }
+
+    bool empty() const {
+        return keys.empty();
+    }
+
+    // |a AND b| without building the intersection
+    static uint64_t andCount(const RoaringBitmap& a, const RoaringBitmap& b) {
+        uint64_t n = 0;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() && j < b.keys.size()) {
+            if (a.keys[i] < b.keys[j]) i++;
+            else if (a.keys[i] > b.keys[j]) j++;
+            else n += andCount(a.containers[i++], b.containers[j++]);
+        }
+        return n;
+    }
+
+    // |sets[0] AND sets[1] AND ...|, visiting only the keys of the set with fewest containers
+    static uint64_t andCount(const std::vector<const RoaringBitmap*>& sets) {
+        if (sets.empty()) return 0;
+        if (sets.size() == 1) return sets[0]->cardinality();
+        if (sets.size() == 2) return andCount(*sets[0], *sets[1]);
+        const RoaringBitmap* fewest = *std::min_element(sets.begin(), sets.end(),
+            [](const RoaringBitmap* a, const RoaringBitmap* b) { return a->keys.size() < b->keys.size(); });
+        std::vector<const Container*> parts(sets.size());
+        uint64_t n = 0;
+        for (uint16_t high : fewest->keys) {
+            const Container* smallest = nullptr;
+            bool present = true;
+            for (size_t s = 0; s < sets.size() && present; s++) {
+                parts[s] = sets[s]->container(high);
+                present = parts[s] != nullptr;
+                if (present && !parts[s]->isBitmap() && (!smallest || parts[s]->count < smallest->count)) {
+                    smallest = parts[s];
+                }
+            }
+            if (!present) continue;
+            if (smallest) { // probe the others for each value of the smallest array
+                for (uint16_t v : smallest->array) {
+                    bool all = true;
+                    for (size_t s = 0; s < parts.size() && all; s++) {
+                        if (parts[s] != smallest) all = parts[s]->contains(v);
+                    }
+                    n += all;
+                }
+            } else {
+                n += andCountBitmaps(parts);
+            }
+        }
+        return n;
+    }
+
+    // Union of many sets, each key's containers merged at once
+    static RoaringBitmap unionOf(const std::vector<const RoaringBitmap*>& sets) {
+        RoaringBitmap out;
+        for (const RoaringBitmap* b : sets) out.keys.insert(out.keys.end(), b->keys.begin(), b->keys.end());
+        std::sort(out.keys.begin(), out.keys.end());
+        out.keys.erase(std::unique(out.keys.begin(), out.keys.end()), out.keys.end());
+        out.containers.resize(out.keys.size());
+        std::vector<const Container*> parts;
+        for (size_t i = 0; i < out.keys.size(); i++) {
+            parts.clear();
+            size_t total = 0;
+            bool anyBitmap = false;
+            for (const RoaringBitmap* b : sets) {
+                if (const Container* c = b->container(out.keys[i])) {
+                    parts.push_back(c);
+                    total += c->count;
+                    anyBitmap = anyBitmap || c->isBitmap();
+                }
+            }
+            Container& c = out.containers[i];
+            if (!anyBitmap && total <= arrayMax) {
+                for (const Container* p : parts) c.array.insert(c.array.end(), p->array.begin(), p->array.end());
+                std::sort(c.array.begin(), c.array.end());
+                c.array.erase(std::unique(c.array.begin(), c.array.end()), c.array.end());
+                c.count = static_cast<uint32_t>(c.array.size());
+                continue;
+            }
+            c.bits.assign(bitmapWords, 0);
+            for (const Container* p : parts) {
+                if (p->isBitmap()) {
+                    for (size_t w = 0; w < bitmapWords; w++) c.bits[w] |= p->bits[w];
+                } else {
+                    for (uint16_t v : p->array) c.bits[v >> 6] |= uint64_t(1) << (v & 63);
+                }
+            }
+            for (size_t w = 0; w < bitmapWords; w++) c.count += popcount(c.bits[w]);
+            c.shrink();
+        }
+        return out;
+    }
+
+    RoaringBitmap operator&(const RoaringBitmap& other) const {
+        RoaringBitmap out;
+        size_t i = 0, j = 0;
+        while (i < keys.size() && j < other.keys.size()) {
+            if (keys[i] < other.keys[j]) {
+                i++;
+            } else if (keys[i] > other.keys[j]) {
+                j++;
+            } else {
+                Container c = intersect(containers[i], other.containers[j]);
+                if (c.count > 0) {
+                    out.keys.push_back(keys[i]);
+                    out.containers.push_back(std::move(c));
+                }
+                i++, j++;
+            }
+        }
+        return out;
+    }
+
+    RoaringBitmap operator|(const RoaringBitmap& other) const {
+        RoaringBitmap out;
+        size_t i = 0, j = 0;
+        while (i < keys.size() || j < other.keys.size()) {
+            if (j == other.keys.size() || (i < keys.size() && keys[i] < other.keys[j])) {
+                out.keys.push_back(keys[i]);
+                out.containers.push_back(containers[i++]);
+            } else if (i == keys.size() || other.keys[j] < keys[i]) {
+                out.keys.push_back(other.keys[j]);
+                out.containers.push_back(other.containers[j++]);
+            } else {
+                out.keys.push_back(keys[i]);
+                out.containers.push_back(unite(containers[i++], other.containers[j++]));
+            }
+        }
+        return out;
+    }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other) {
+        return *this = *this & other;
+    }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other) {
+        return *this = *this | other;
+    }
+
+    // Calls fn(id) for every id, in increasing order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint32_t base = static_cast<uint32_t>(keys[i]) << 16;
+            const Container& c = containers[i];
+            if (c.isBitmap()) {
+                for (size_t w = 0; w < bitmapWords; w++) {
+                    for (uint64_t b = c.bits[w]; b; b &= b - 1) fn(base | static_cast<uint32_t>(w * 64 + __builtin_ctzll(b)));
+                }
+            } else {
+                for (uint16_t v : c.array) fn(base | v);
+            }
+        }
+    }
+
+    // Approximate heap bytes used by the containers
+    size_t bytes() const {
+        size_t n = keys.capacity() * sizeof(uint16_t) + containers.capacity() * sizeof(Container);
+        for (const Container& c : containers) n += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+        return n;
+    }
+};
+
+#endif
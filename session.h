@@ -0,0 +1,151 @@
+// session.h
+#ifndef SESSION_H
+#define SESSION_H
+
+// Session tokens with per-session state.
+// Tokens live in a fixed number of shards, each with its own mutex, hash map
+// and timer wheel, so concurrent logins and lookups only contend when they hit
+// the same shard. Expiry is sliding: every successful lookup pushes it back by
+// the TTL. Each shard's wheel is advanced lazily whenever the shard is touched,
+// so expired sessions are dropped without ever scanning all of them.
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+template <typename State>
+class SessionManager {
+private:
+    static constexpr int shardCount = 16;
+    static constexpr int wheelSlots = 256; // one slot per second
+
+    struct Entry {
+        State state;
+        int64_t expiresAt; // in seconds (steady clock)
+    };
+
+    struct Shard {
+        std::mutex mtx;
+        std::unordered_map<std::string, Entry> sessions;
+        std::vector<std::vector<std::string>> wheel;
+        int64_t wheelTime = -1; // last second the wheel was advanced to
+
+        Shard() : wheel(wheelSlots) {}
+    };
+
+    Shard shards[shardCount];
+    int64_t ttlSeconds;
+
+    static int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Shard& shardFor(const std::string& token) {
+        return shards[std::hash<std::string>()(token) % shardCount];
+    }
+
+    static void schedule(Shard& shard, const std::string& token, int64_t expiresAt) {
+        shard.wheel[expiresAt % wheelSlots].push_back(token);
+    }
+
+    // Fires every wheel slot between the last advance and now. Sessions that
+    // were extended since they were scheduled are moved to their new slot.
+    static void advance(Shard& shard, int64_t now) {
+        if (shard.wheelTime < 0) {
+            shard.wheelTime = now;
+            return;
+        }
+        int64_t from = shard.wheelTime + 1;
+        if (now - from >= wheelSlots) from = now - wheelSlots + 1; // every slot fires once at most
+        for (int64_t t = from; t <= now; t++) {
+            std::vector<std::string> due;
+            due.swap(shard.wheel[t % wheelSlots]);
+            for (auto& token : due) {
+                auto it = shard.sessions.find(token);
+                if (it == shard.sessions.end()) continue; // already revoked
+                if (it->second.expiresAt <= now) {
+                    shard.sessions.erase(it);
+                } else {
+                    schedule(shard, token, it->second.expiresAt);
+                }
+            }
+        }
+        shard.wheelTime = now;
+    }
+
+    static std::string newToken() {
+        thread_local std::mt19937_64 rng(std::random_device{}() ^
+            std::hash<std::thread::id>()(std::this_thread::get_id()));
+        static const char hex[] = "0123456789abcdef";
+        std::string token(32, '0');
+        uint64_t parts[2] = {rng(), rng()};
+        for (int i = 0; i < 32; i++) {
+            token[i] = hex[(parts[i / 16] >> ((i % 16) * 4)) & 0xF];
+        }
+        return token;
+    }
+
+public:
+    explicit SessionManager(int64_t ttlSeconds = 30 * 60) : ttlSeconds(ttlSeconds) {}
+
+    // Starts a session and returns its token
+    std::string create(const State& state) {
+        std::string token = newToken();
+        Shard& shard = shardFor(token);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        int64_t now = nowSeconds();
+        advance(shard, now);
+        shard.sessions[token] = Entry{state, now + ttlSeconds};
+        schedule(shard, token, now + ttlSeconds);
+        return token;
+    }
+
+    // Copies the session state into out and extends the session.
+    // Returns false if the token is unknown or expired.
+    bool lookup(const std::string& token, State& out) {
+        if (token.empty()) return false;
+        Shard& shard = shardFor(token);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        int64_t now = nowSeconds();
+        advance(shard, now);
+        auto it = shard.sessions.find(token);
+        if (it == shard.sessions.end() || it->second.expiresAt <= now) return false;
+        it->second.expiresAt = now + ttlSeconds; // rescheduled lazily when its old slot fires
+        out = it->second.state;
+        return true;
+    }
+
+    bool isValid(const std::string& token) {
+        State ignored;
+        return lookup(token, ignored);
+    }
+
+    // Ends a session. Its wheel entry is skipped when it fires.
+    void revoke(const std::string& token) {
+        if (token.empty()) return;
+        Shard& shard = shardFor(token);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.sessions.erase(token);
+    }
+
+    // Number of live sessions (expired ones are dropped first)
+    size_t size() {
+        size_t total = 0;
+        int64_t now = nowSeconds();
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            advance(shard, now);
+            total += shard.sessions.size();
+        }
+        return total;
+    }
+};
+
+#endif
@@ -0,0 +1,283 @@
+// tinylfu.h
+#ifndef TINYLFU_H
+#define TINYLFU_H
+
+// Bounded in-process cache with W-TinyLFU eviction.
+// New entries go into a small LRU window (1% of the capacity). When the
+// window overflows, its oldest entry becomes a candidate for the main area,
+// a segmented LRU (probation, then protected once hit again). If the cache is
+// full the candidate only gets in if it has been used more often than
+// the entry main would evict, going by a count-min sketch of recent use. So a
+// burst of one-off lookups cannot push out the donors that are asked for all
+// day, while the window still catches new hot keys.
+//
+// The capacity is in entries. Not thread-safe: callers hold their own lock.
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "containers.h"
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t loads = 0;        // misses that went to the store
+    uint64_t loadNs = 0;       // time spent in those loads
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+
+    double hitRate() const {
+        return hits + misses == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+
+    double averageLoadMicros() const {
+        return loads == 0 ? 0 : static_cast<double>(loadNs) / 1000.0 / static_cast<double>(loads);
+    }
+};
+
+// Approximate use counts: 4 rows of 4-bit counters, halved every
+// 10 x capacity increments so old popularity fades
+class FrequencySketch {
+private:
+    std::vector<uint8_t> counters; // 2 counters per byte
+    size_t mask = 0;                // counters per row - 1
+    size_t additions = 0;
+    size_t sampleSize = 0;
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        return h ^ (h >> 33);
+    }
+
+    size_t slot(uint64_t h, int row) const {
+        uint64_t a = h, b = (h >> 32) | 1;
+        return static_cast<size_t>(row) * (mask + 1) + ((a + static_cast<uint64_t>(row) * b) & mask);
+    }
+
+    int get(size_t i) const {
+        return (counters[i >> 1] >> ((i & 1) * 4)) & 15;
+    }
+
+    void halve() {
+        for (uint8_t& c : counters) c = static_cast<uint8_t>((c >> 1) & 0x77);
+        additions /= 2;
+    }
+
+public:
+    explicit FrequencySketch(size_t capacity = 16) {
+        size_t width = 16;
+        while (width < capacity) width *= 2;
+        mask = width - 1;
+        counters.assign(width * 4 / 2, 0);
+        sampleSize = 10 * (capacity > 0 ? capacity : 1);
+    }
+
+    void increment(size_t hash) {
+        uint64_t h = mix(hash);
+        bool added = false;
+        for (int row = 0; row < 4; row++) {
+            size_t i = slot(h, row);
+            if (get(i) < 15) {
+                counters[i >> 1] = static_cast<uint8_t>(counters[i >> 1] + (1 << ((i & 1) * 4)));
+                added = true;
+            }
+        }
+        if (added && ++additions >= sampleSize) halve();
+    }
+
+    int frequency(size_t hash) const {
+        uint64_t h = mix(hash);
+        int f = 15;
+        for (int row = 0; row < 4; row++) {
+            int c = get(slot(h, row));
+            if (c < f) f = c;
+        }
+        return f;
+    }
+};
+
+template <typename K, typename V, typename Hash = std::hash<K>>
+class TinyLfuCache {
+private:
+    enum Region : uint8_t { WINDOW, PROBATION, PROTECTED, FREE };
+
+    struct Node {
+        K key;
+        V value;
+        int prev = -1;
+        int next = -1;
+        Region region = FREE;
+    };
+
+    // Doubly linked through node indices, most recently used at the head
+    struct Lru {
+        int head = -1;
+        int tail = -1;
+        size_t size = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    FlatHashMap<K, int, Hash> index;
+    Lru lists[3];
+    size_t maxEntries;
+    size_t maxWindow;
+    size_t maxProtected;
+    FrequencySketch sketch;
+    Hash hasher;
+    CacheStats counters;
+
+    void unlink(int n) {
+        Node& node = nodes[n];
+        Lru& list = lists[node.region];
+        if (node.prev >= 0) nodes[node.prev].next = node.next;
+        else list.head = node.next;
+        if (node.next >= 0) nodes[node.next].prev = node.prev;
+        else list.tail = node.prev;
+        list.size--;
+    }
+
+    void pushHead(int n, Region region) {
+        Node& node = nodes[n];
+        Lru& list = lists[region];
+        node.region = region;
+        node.prev = -1;
+        node.next = list.head;
+        if (list.head >= 0) nodes[list.head].prev = n;
+        list.head = n;
+        if (list.tail < 0) list.tail = n;
+        list.size++;
+    }
+
+    void moveTo(int n, Region region) {
+        unlink(n);
+        pushHead(n, region);
+    }
+
+    void remove(int n) {
+        unlink(n);
+        index.erase(nodes[n].key);
+        nodes[n].key = K();
+        nodes[n].value = V();
+        nodes[n].region = FREE;
+        freeNodes.push_back(n);
+    }
+
+    size_t size() const {
+        return lists[WINDOW].size + lists[PROBATION].size + lists[PROTECTED].size;
+    }
+
+    // A hit: window entries stay in the window, main entries move up to protected
+    void touch(int n) {
+        sketch.increment(hasher(nodes[n].key));
+        if (nodes[n].region != PROBATION) {
+            moveTo(n, nodes[n].region);
+            return;
+        }
+        moveTo(n, PROTECTED);
+        if (lists[PROTECTED].size > maxProtected) moveTo(lists[PROTECTED].tail, PROBATION);
+    }
+
+    // Moves window overflow into main, then evicts whichever of the newcomer
+    // and main's LRU entry is used less
+    void evict() {
+        while (lists[WINDOW].size > maxWindow) {
+            int candidate = lists[WINDOW].tail;
+            moveTo(candidate, PROBATION);
+            if (size() <= maxEntries) continue;
+            int victim = lists[PROBATION].tail;
+            if (victim == candidate && lists[PROTECTED].size > 0) victim = lists[PROTECTED].tail;
+            bool admit = victim != candidate &&
+                         sketch.frequency(hasher(nodes[candidate].key)) > sketch.frequency(hasher(nodes[victim].key));
+            remove(admit ? victim : candidate);
+            counters.evictions++;
+        }
+    }
+
+public:
+    explicit TinyLfuCache(size_t capacity, Hash hasher = Hash())
+        : index(hasher), maxEntries(capacity > 0 ? capacity : 1), sketch(maxEntries), hasher(hasher) {
+        maxWindow = maxEntries / 100 > 0 ? maxEntries / 100 : 1;
+        maxProtected = (maxEntries - (maxEntries > maxWindow ? maxWindow : 0)) * 8 / 10;
+        nodes.reserve(maxEntries + 1); // pointers handed out stay valid until the next change
+        index.reserve(maxEntries + 1);
+    }
+
+    // Cached value or nullptr, counted as a hit or miss
+    V* find(const K& key) {
+        const int* n = index.find(key);
+        if (!n) {
+            counters.misses++;
+            sketch.increment(hasher(key)); // misses count towards admission too
+            return nullptr;
+        }
+        counters.hits++;
+        touch(*n);
+        return &nodes[*n].value;
+    }
+
+    // Adds or replaces an entry (write-through after the store took the write)
+    V* put(const K& key, V value) {
+        if (const int* n = index.find(key)) {
+            nodes[*n].value = std::move(value);
+            touch(*n);
+            return &nodes[*n].value;
+        }
+        int n;
+        if (!freeNodes.empty()) {
+            n = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            n = static_cast<int>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[n].key = key;
+        nodes[n].value = std::move(value);
+        index.insert(key, n);
+        pushHead(n, WINDOW);
+        evict(); // the newcomer is at the window head, so it stays
+        return &nodes[n].value;
+    }
+
+    // Read-through: the cached value, or load(value) from the store and cache
+    // it. nullptr if the store has nothing for the key (not cached).
+    template <typename Loader>
+    V* get(const K& key, Loader load) {
+        if (V* cached = find(key)) return cached;
+        auto start = std::chrono::steady_clock::now();
+        V value;
+        bool found = load(value);
+        counters.loads++;
+        counters.loadNs += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        return found ? put(key, std::move(value)) : nullptr;
+    }
+
+    // Drops an entry after its record changed in the store
+    bool invalidate(const K& key) {
+        const int* n = index.find(key);
+        if (!n) return false;
+        remove(*n);
+        counters.invalidations++;
+        return true;
+    }
+
+    const CacheStats& stats() const {
+        return counters;
+    }
+
+    size_t entries() const {
+        return size();
+    }
+
+    size_t capacity() const {
+        return maxEntries;
+    }
+};
+
+#endif
@@ -0,0 +1,313 @@
+// wal.h
+#ifndef WAL_H
+#define WAL_H
+
+// Append-only write-ahead log with group commit.
+// Each record is framed as [length][crc32][payload]; a torn or corrupt record
+// at the end of the file (a crash mid-write) ends replay instead of failing it.
+// Appends are buffered and written + fsync'd together by a background thread.
+// append() returns a ticket; waitDurable(ticket) blocks until the group
+// holding that record is on disk. Only then is the change safe from a crash.
+// As soon as a thread is waiting, the flusher commits everything pending
+// (leader/follower): records appended while that fsync runs form the next
+// group, so concurrent writers share fsyncs and a lone writer never waits
+// for a timer. With nobody waiting, a group is committed once it holds
+// groupSize records or its oldest has waited maxDelayMs, or on sync().
+// Snapshots for checkpoints are written with writeSnapshot(), which replaces
+// the old file atomically. setHeader() gives a record (e.g. a format version)
+// that starts every log file the log creates or empties.
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+inline uint32_t crc32(const char* data, size_t size) {
+    // Built once, thread-safely, on first use (several logs may run at once)
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+inline bool syncFile(FILE* f) {
+    if (fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Appends one framed record to buf
+inline void frameRecord(std::string& buf, const std::string& payload) {
+    uint32_t header[2] = {static_cast<uint32_t>(payload.size()), crc32(payload.data(), payload.size())};
+    buf.append(reinterpret_cast<const char*>(header), sizeof(header));
+    buf += payload;
+}
+
+// Calls fn for every intact record in a file. Returns the number of records,
+// or -1 if the file can't be read (a missing file counts as empty).
+inline long long readRecords(const std::string& path, const std::function<void(const std::string&)>& fn) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return 0;
+    std::string data;
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.append(chunk, n);
+    bool failed = ferror(f) != 0;
+    fclose(f);
+    if (failed) return -1;
+
+    long long count = 0;
+    size_t pos = 0;
+    std::string payload;
+    while (pos + 8 <= data.size()) {
+        uint32_t header[2];
+        data.copy(reinterpret_cast<char*>(header), 8, pos);
+        if (pos + 8 + header[0] > data.size()) break; // torn tail
+        payload.assign(data, pos + 8, header[0]);
+        if (crc32(payload.data(), payload.size()) != header[1]) break;
+        fn(payload);
+        count++;
+        pos += 8 + header[0];
+    }
+    return count;
+}
+
+// Writes records to path.tmp, syncs it and renames it over path
+inline bool writeSnapshot(const std::string& path, const std::vector<std::string>& records) {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    std::string buf;
+    bool ok = true;
+    for (const auto& r : records) {
+        frameRecord(buf, r);
+        if (buf.size() >= (1 << 20)) {
+            ok = ok && fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+            buf.clear();
+        }
+    }
+    ok = ok && fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    ok = syncFile(f) && ok;
+    fclose(f);
+    if (!ok) return false;
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+class WriteAheadLog {
+private:
+    std::string path;
+    FILE* file = nullptr;
+    std::string pending;        // framed records not yet written
+    size_t pendingRecords = 0;
+    size_t groupSize;
+    int maxDelayMs;
+    std::chrono::steady_clock::time_point firstPending;
+    long long recordsSinceReset = 0;
+    long long syncs = 0;
+    std::string header;         // first record of a new or emptied file, if set
+    long long appended = 0;     // tickets handed out by append()
+    long long durable = 0;      // every ticket up to this one is on disk
+    long long wanted = 0;       // highest ticket a thread is blocked on in waitDurable()
+    bool failed = false;        // a write or fsync failed since open/reset
+    bool flushing = false;      // a group is being written outside the lock
+    bool stopping = false;
+
+    mutable std::mutex mtx;
+    std::condition_variable wake;   // for the flusher: records arrived, or closing
+    std::condition_variable synced; // for waiters: `durable` moved on
+    std::thread flusher;
+
+    // Writes and fsyncs the pending group with the lock released, so appends
+    // carry on meanwhile. Called with the lock held.
+    bool flushLocked(std::unique_lock<std::mutex>& lock) {
+        synced.wait(lock, [this]() { return !flushing; });
+        if (pendingRecords == 0 || !file) return !failed;
+        std::string group;
+        group.swap(pending);
+        long long upTo = appended;
+        pendingRecords = 0;
+        flushing = true;
+        lock.unlock();
+        bool ok = fwrite(group.data(), 1, group.size(), file) == group.size();
+        ok = syncFile(file) && ok;
+        lock.lock();
+        flushing = false;
+        failed = failed || !ok;
+        durable = upTo;
+        syncs++;
+        synced.notify_all();
+        return !failed;
+    }
+
+    // Starts an empty file with the header record and syncs it
+    bool writeHeader() {
+        std::string framed;
+        if (!header.empty()) frameRecord(framed, header);
+        return fwrite(framed.data(), 1, framed.size(), file) == framed.size() && syncFile(file);
+    }
+
+    // Background thread: commits the pending group at once if someone waits
+    // on it, otherwise once it is full or its first record has waited
+    // maxDelayMs, so no record sits in memory longer than that
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!stopping) {
+            if (pendingRecords == 0) {
+                wake.wait(lock);
+                continue;
+            }
+            auto deadline = firstPending + std::chrono::milliseconds(maxDelayMs);
+            if (wanted <= durable && pendingRecords < groupSize && std::chrono::steady_clock::now() < deadline) {
+                wake.wait_until(lock, deadline);
+                continue;
+            }
+            flushLocked(lock);
+        }
+    }
+
+public:
+    explicit WriteAheadLog(size_t groupSize = 64, int maxDelayMs = 10)
+        : groupSize(groupSize), maxDelayMs(maxDelayMs) {}
+
+    ~WriteAheadLog() {
+        close();
+    }
+
+    // Record written at the start of every empty log file; not counted in
+    // recordCount(). Set it before open().
+    void setHeader(const std::string& payload) {
+        header = payload;
+    }
+
+    // Opens (or creates) the log for appending. existingRecords is how many
+    // records recovery found in it, so recordCount() stays accurate.
+    bool open(const std::string& logPath, long long existingRecords = 0) {
+        close();
+        path = logPath;
+        file = fopen(path.c_str(), "ab");
+        recordsSinceReset = existingRecords;
+        if (!file) return false;
+        if (fseek(file, 0, SEEK_END) != 0 || (ftell(file) == 0 && !writeHeader())) {
+            fclose(file);
+            file = nullptr;
+            return false;
+        }
+        failed = false;
+        stopping = false;
+        flusher = std::thread(&WriteAheadLog::flushLoop, this);
+        return true;
+    }
+
+    bool isOpen() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return file != nullptr;
+    }
+
+    // Buffers a record for the next group commit. Returns its ticket for
+    // waitDurable(), or -1 if the log isn't open (closed, or lost when a
+    // reset could not reopen the file): the record was not logged.
+    long long append(const std::string& payload) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!file) return -1;
+        if (pendingRecords == 0) firstPending = std::chrono::steady_clock::now();
+        frameRecord(pending, payload);
+        pendingRecords++;
+        recordsSinceReset++;
+        // The flusher needs to hear about a new group (to start its clock) and a full one
+        if (pendingRecords == 1 || pendingRecords >= groupSize) wake.notify_one();
+        return ++appended;
+    }
+
+    // Blocks until the group commit covering `ticket` is on disk.
+    // False if that write or fsync failed.
+    bool waitDurable(long long ticket) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (ticket > durable && file) {
+            // Ask for the group now rather than at its deadline
+            if (ticket > wanted) wanted = ticket;
+            wake.notify_one();
+        }
+        synced.wait(lock, [&]() { return durable >= ticket || !file; });
+        return durable >= ticket && !failed;
+    }
+
+    // Writes and fsyncs everything appended so far without waiting for the group
+    bool sync() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!file) return false;
+        return flushLocked(lock);
+    }
+
+    // Empties the log (after a checkpoint has captured its contents)
+    bool reset() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!file) return false;
+        synced.wait(lock, [this]() { return !flushing; });
+        pending.clear();
+        pendingRecords = 0;
+        fclose(file);
+        file = fopen(path.c_str(), "wb");
+        recordsSinceReset = 0;
+        failed = file == nullptr || !writeHeader();
+        durable = appended; // the checkpoint holds whatever was still pending
+        synced.notify_all();
+        return !failed;
+    }
+
+    void close() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!flusher.joinable()) return;
+        flushLocked(lock);
+        stopping = true;
+        wake.notify_one();
+        lock.unlock();
+        flusher.join();
+        lock.lock();
+        flushLocked(lock); // anything appended while the flusher was stopping
+        if (file) fclose(file);
+        file = nullptr;
+        synced.notify_all();
+    }
+
+    long long recordCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return recordsSinceReset;
+    }
+
+    long long syncCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return syncs;
+    }
+
+    const std::string& logPath() const {
+        return path;
+    }
+};
+
+#endif